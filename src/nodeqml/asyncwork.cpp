@@ -0,0 +1,32 @@
+#include "asyncwork.h"
+
+using namespace NodeQml;
+
+AsyncWork::AsyncWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &syscall,
+                     const QString &path) :
+    m_callback(v4, callback.asReturnedValue()),
+    m_syscall(syscall),
+    m_path(path)
+{
+
+}
+
+void AsyncWork::appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments)
+{
+    Q_UNUSED(v4)
+    Q_UNUSED(arguments)
+}
+
+#ifdef NODEQML_IO_URING
+struct io_uring_sqe *AsyncWork::prepare(struct io_uring *ring)
+{
+    Q_UNUSED(ring)
+    return nullptr;
+}
+
+void AsyncWork::complete(int result)
+{
+    if (result < 0)
+        setError(-result);
+}
+#endif
@@ -0,0 +1,59 @@
+#ifndef ASYNCWORK_H
+#define ASYNCWORK_H
+
+#include <QString>
+
+#include <private/qv4engine_p.h>
+#include <private/qv4persistent_p.h>
+
+#ifdef NODEQML_IO_URING
+struct io_uring;
+struct io_uring_sqe;
+#endif
+
+namespace NodeQml {
+
+/// A request run on the engine's worker pool, like a libuv uv_work_t.
+/// execute() runs on a pool thread and must not touch the JS heap. Once it
+/// returns, the engine thread calls callback(error) on failure or
+/// callback(null, ...results) on success and deletes the work.
+class AsyncWork
+{
+public:
+    AsyncWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &syscall,
+              const QString &path = QString());
+    virtual ~AsyncWork() {}
+
+    virtual void execute() = 0;
+
+    // Appends the callback arguments following the error, on the engine thread
+    virtual void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments);
+
+#ifdef NODEQML_IO_URING
+    // Work that is a single syscall may bypass the pool: prepare() takes a
+    // submission entry from ring, or returns nullptr to run execute() as
+    // usual, and complete() then receives the syscall's result or -errno
+    virtual struct io_uring_sqe *prepare(struct io_uring *ring);
+    virtual void complete(int result);
+#endif
+
+    int errorNo() const { return m_errorNo; }
+    const QString &syscall() const { return m_syscall; }
+    const QString &path() const { return m_path; }
+    QV4::ReturnedValue callback() const { return m_callback.value(); }
+
+protected:
+    void setError(int errorNo) { m_errorNo = errorNo; }
+
+private:
+    Q_DISABLE_COPY(AsyncWork)
+
+    QV4::PersistentValue m_callback;
+    QString m_syscall;
+    QString m_path;
+    int m_errorNo = 0;
+};
+
+} // namespace NodeQml
+
+#endif // ASYNCWORK_H
@@ -1,19 +1,34 @@
 #include "engine.h"
 #include "engine_p.h"
 
+#include "asyncwork.h"
+#include "eventloopmonitor.h"
 #include "globalextensions.h"
+#ifdef NODEQML_IO_URING
+#include "iouring.h"
+#endif
 #include "moduleobject.h"
+#include "modules/console.h"
 #include "modules/filesystem.h"
 #include "modules/os.h"
 #include "modules/path.h"
+#include "modules/perfhooks.h"
+#include "modules/process.h"
 #include "modules/util.h"
 #include "types/buffer.h"
 #include "types/errnoexception.h"
+#include "types/histogram.h"
+#include "types/immediate.h"
+#include "types/stats.h"
+#include "types/timeout.h"
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QLoggingCategory>
 #include <QQmlEngine>
+#include <QRunnable>
 #include <QTimerEvent>
 
 #include <private/qjsvalue_p.h>
@@ -22,6 +37,26 @@
 
 namespace {
 const QLoggingCategory logCategory("nodeqml.core");
+
+// libuv's default and upper bound for UV_THREADPOOL_SIZE
+const int DefaultWorkerCount = 4;
+const int MaxWorkerCount = 1024;
+
+// Growth of live buffer memory since the last collection that forces a GC
+const qint64 MinExternalMemoryGrowth = 32 * 1024 * 1024;
+
+template <typename T>
+QV4::ReturnedValue createModule(QV4::ExecutionEngine *v4)
+{
+    return v4->memoryManager->alloc<T>(v4)->asReturnedValue();
+}
+
+// Top-level requires have no parent path and resolve against the working
+// directory, which process.chdir() can change
+inline QString resolveCacheKey(const QString &parentPath, const QString &request)
+{
+    return QDir(parentPath).absolutePath() + QChar(0) + request;
+}
 }
 
 using namespace NodeQml;
@@ -29,16 +64,32 @@ using namespace NodeQml;
 class NextTickEvent : public QEvent
 {
 public:
-    NextTickEvent(const QV4::PersistentValue &callback) :
-        QEvent(NextTickEvent::eventType()),
-        m_callback(callback)
+    NextTickEvent() :
+        QEvent(NextTickEvent::eventType())
     {
 
     }
 
-    QV4::PersistentValue callback() const
+    static QEvent::Type eventType()
     {
-        return m_callback;
+        if (m_type == QEvent::None)
+            m_type = static_cast<QEvent::Type>(QEvent::registerEventType());
+        return m_type;
+    }
+
+private:
+    static QEvent::Type m_type;
+};
+
+QEvent::Type NextTickEvent::m_type = QEvent::None;
+
+class ImmediateEvent : public QEvent
+{
+public:
+    ImmediateEvent() :
+        QEvent(ImmediateEvent::eventType())
+    {
+
     }
 
     static QEvent::Type eventType()
@@ -50,10 +101,61 @@ public:
 
 private:
     static QEvent::Type m_type;
-    QV4::PersistentValue m_callback;
 };
 
-QEvent::Type NextTickEvent::m_type = QEvent::None;
+QEvent::Type ImmediateEvent::m_type = QEvent::None;
+
+// Posted once per batch of completed async work
+class WorkCompletedEvent : public QEvent
+{
+public:
+    WorkCompletedEvent() :
+        QEvent(WorkCompletedEvent::eventType())
+    {
+
+    }
+
+    static QEvent::Type eventType()
+    {
+        if (m_type == QEvent::None)
+            m_type = static_cast<QEvent::Type>(QEvent::registerEventType());
+        return m_type;
+    }
+
+private:
+    static QEvent::Type m_type;
+};
+
+QEvent::Type WorkCompletedEvent::m_type = QEvent::None;
+
+// Owns the work until run() hands it to the engine; QThreadPool::clear()
+// deletes runnables that never started
+class WorkRunnable : public QRunnable
+{
+public:
+    WorkRunnable(EnginePrivate *engine, AsyncWork *work) :
+        m_engine(engine),
+        m_work(work)
+    {
+
+    }
+
+    ~WorkRunnable()
+    {
+        delete m_work;
+    }
+
+    void run() override
+    {
+        m_work->execute();
+        m_engine->completeWork(m_work);
+        m_work = nullptr;
+    }
+
+private:
+    EnginePrivate *m_engine;
+    AsyncWork *m_work;
+};
 
 Engine::Engine(QQmlEngine *qmlEngine, QObject *parent) :
     QObject(parent),
@@ -65,7 +167,72 @@ Engine::Engine(QQmlEngine *qmlEngine, QObject *parent) :
 QJSValue Engine::require(const QString &id)
 {
     Q_D(Engine);
-    return new QJSValuePrivate(d->require(id));
+    EventLoopMonitor::ActiveScope active(d->m_loopMonitor);
+    QJSValue result = new QJSValuePrivate(d->require(id));
+    d->scheduleAliveCheck();
+    return result;
+}
+
+QJSValue Engine::newBuffer(QByteArray &&data)
+{
+    Q_D(Engine);
+    return new QJSValuePrivate(d->newBuffer(&data));
+}
+
+QJSValue Engine::newBuffer(const QByteArray &data)
+{
+    Q_D(Engine);
+    // Shared with the caller's array, so this copies
+    QByteArray shared(data);
+    return new QJSValuePrivate(d->newBuffer(&shared));
+}
+
+QJSValue Engine::newBuffer(char *data, size_t length, BufferCleanupFunction cleanupFunction, void *cleanupInfo)
+{
+    Q_D(Engine);
+    return new QJSValuePrivate(d->newBuffer(data, length, cleanupFunction, cleanupInfo));
+}
+
+bool Engine::isAlive() const
+{
+    Q_D(const Engine);
+    return d->isAlive();
+}
+
+EventLoopStatistics Engine::eventLoopStatistics() const
+{
+    Q_D(const Engine);
+    EventLoopMonitor *monitor = d->m_loopMonitor;
+    const HdrHistogram *delay = monitor->delayHistogram();
+
+    EventLoopStatistics stats;
+    stats.idleTime = monitor->idleTime();
+    stats.activeTime = monitor->activeTime();
+    const qint64 total = stats.idleTime + stats.activeTime;
+    stats.utilization = total > 0 ? double(stats.activeTime) / total : 0;
+
+    if (!delay)
+        return stats;
+
+    stats.delayCount = delay->count();
+    stats.delayMin = delay->min();
+    stats.delayMax = delay->max();
+    stats.delayMean = delay->mean();
+    stats.delayStddev = delay->stddev();
+    stats.delayP50 = delay->valueAtPercentile(50);
+    stats.delayP90 = delay->valueAtPercentile(90);
+    stats.delayP99 = delay->valueAtPercentile(99);
+    return stats;
+}
+
+void Engine::setEventLoopDelayMonitoringEnabled(bool enabled, int resolution)
+{
+    Q_D(Engine);
+    EventLoopMonitor *monitor = d->m_loopMonitor;
+    if (enabled)
+        monitor->startSampling(monitor->ensureDelayHistogram(), qMax(1, resolution));
+    else
+        monitor->stopSampling(monitor->delayHistogram());
 }
 
 bool Engine::hasException() const
@@ -85,31 +252,84 @@ EnginePrivate::EnginePrivate(QQmlEngine *qmlEngine, Engine *engine) :
     QObject(engine),
     q_ptr(engine),
     m_qmlEngine(qmlEngine),
-    m_v4(QV8Engine::getV4(qmlEngine))
+    m_v4(QV8Engine::getV4(qmlEngine)),
+    m_tickQueue(m_v4),
+    m_immediateQueue(m_v4),
+    m_loopMonitor(new EventLoopMonitor(this)),
+    m_externalMemoryLimit(MinExternalMemoryGrowth)
 {
     /// TODO: Mutex
     m_nodeEngines.insert(m_v4, this);
 
+    m_clock.start();
+
+    m_packageIndex.setPersistent(qEnvironmentVariableIsSet("NODEQML_PACKAGE_INDEX"));
+
+    bool ok = false;
+    const int workerCount = qgetenv("UV_THREADPOOL_SIZE").toInt(&ok);
+    m_workerPool.setMaxThreadCount(ok && workerCount > 0 ? qMin(workerCount, MaxWorkerCount) : DefaultWorkerCount);
+    // Registered up front, since pool threads post it
+    WorkCompletedEvent::eventType();
+
+#ifdef NODEQML_IO_URING
+    if (!qEnvironmentVariableIsSet("NODEQML_DISABLE_IO_URING")) {
+        m_ioUring = new IoUring(this);
+        if (!m_ioUring->isValid()) {
+            delete m_ioUring;
+            m_ioUring = nullptr;
+        }
+    }
+#endif
+
+    // Opt-in, since inotify watches are a limited resource
+    if (qEnvironmentVariableIsSet("NODEQML_WATCH_MODULES")) {
+        m_moduleWatcher = new QFileSystemWatcher(this);
+        connect(m_moduleWatcher, &QFileSystemWatcher::directoryChanged, this, &EnginePrivate::invalidateResolvedModules);
+        connect(m_moduleWatcher, &QFileSystemWatcher::fileChanged, this, &EnginePrivate::invalidateResolvedModules);
+    }
+
     NodeQml::GlobalExtensions::init(m_qmlEngine);
     registerTypes();
-    /// TODO: Core modules should not be loaded unless required
     registerModules();
 }
 
 EnginePrivate::~EnginePrivate()
 {
+    m_timerWheel.clear();
+
+    // Work still running is finished, but its callbacks are dropped
+#ifdef NODEQML_IO_URING
+    delete m_ioUring;
+#endif
+    m_workerPool.clear();
+    m_workerPool.waitForDone();
+    qDeleteAll(m_completedWork);
+
     m_nodeEngines.remove(m_v4);
 }
 
 bool EnginePrivate::hasNativeModule(const QString &id) const
 {
-    return m_coreModules.contains(id);
+    return m_moduleFactories.contains(id);
 }
 
-QV4::Object *EnginePrivate::nativeModule(const QString &id) const
+QV4::Object *EnginePrivate::nativeModule(const QString &id)
 {
     QV4::Scope scope(m_v4);
-    QV4::Scoped<QV4::Object> module(scope, m_coreModules.value(id));
+    QV4::ScopedObject module(scope);
+
+    QHash<QString, QV4::PersistentValue>::const_iterator it = m_coreModules.constFind(id);
+    if (it != m_coreModules.constEnd()) {
+        module = it.value();
+    } else {
+        ModuleFactory factory = m_moduleFactories.value(id);
+        if (!factory)
+            return nullptr;
+
+        module = factory(m_v4);
+        m_coreModules.insert(id, module.asReturnedValue());
+    }
+
     return module.getPointer();
 }
 
@@ -137,6 +357,53 @@ QV4::ReturnedValue EnginePrivate::require(const QString &id, QV4::ExecutionConte
     return ModuleObject::require(ctx, id)->asReturnedValue();
 }
 
+bool EnginePrivate::lookupResolvedModule(const QString &parentPath, const QString &request, QString *filename) const
+{
+    QHash<QString, QString>::const_iterator it = m_resolvedModules.constFind(resolveCacheKey(parentPath, request));
+    if (it == m_resolvedModules.constEnd())
+        return false;
+
+    *filename = it.value();
+    return true;
+}
+
+void EnginePrivate::cacheResolvedModule(const QString &parentPath, const QString &request, const QString &filename)
+{
+    // Without the watcher nothing would expire a miss once the file shows up
+    if (!m_moduleWatcher) {
+        if (!filename.isEmpty())
+            m_resolvedModules.insert(resolveCacheKey(parentPath, request), filename);
+        return;
+    }
+
+    m_resolvedModules.insert(resolveCacheKey(parentPath, request), filename);
+
+    // A new file next to the candidate can change the result, so its directory is watched too
+    if (QDir::isRelativePath(request))
+        watchModulePath(QFileInfo(QDir(parentPath).filePath(request)).absolutePath());
+    else
+        watchModulePath(QFileInfo(request).absolutePath());
+
+    if (!filename.isEmpty() && !filename.startsWith(QLatin1Char(':')))
+        watchModulePath(filename);
+}
+
+void EnginePrivate::watchModulePath(const QString &path)
+{
+    if (m_watchedPaths.contains(path) || !QFileInfo::exists(path))
+        return;
+
+    m_watchedPaths.insert(path);
+    m_moduleWatcher->addPath(path);
+}
+
+void EnginePrivate::invalidateResolvedModules()
+{
+    qCDebug(logCategory, "Module paths changed, clearing resolution cache");
+    m_resolvedModules.clear();
+    m_packageIndex.clear();
+}
+
 QV4::ReturnedValue EnginePrivate::setTimeout(QV4::CallContext *ctx)
 {
     NODE_CTX_CALLDATA(ctx);
@@ -156,14 +423,7 @@ QV4::ReturnedValue EnginePrivate::setTimeout(QV4::CallContext *ctx)
     if (delay <= 0)
         delay = 1;
 
-    const int timerId = startTimer(delay, Qt::PreciseTimer);
-    if (!timerId)
-        return m_v4->throwError("setTimeout: cannot start timer");
-
-    m_timeoutCallbacks.insert(timerId, cb.asReturnedValue());
-
-    /// TODO: Return an object similar to Node's
-    return QV4::Encode(timerId);
+    return addTimer(ctx, cb.getPointer(), delay, false);
 }
 
 QV4::ReturnedValue EnginePrivate::clearTimeout(QV4::CallContext *ctx)
@@ -172,14 +432,13 @@ QV4::ReturnedValue EnginePrivate::clearTimeout(QV4::CallContext *ctx)
     if (callData->argc < 1)
         return m_v4->throwError("clearTimeout: missing arguments");
 
-    if (!callData->args[0].isNumber())
-        return m_v4->throwTypeError("clearTimeout: timeout must be an integer (at the moment)");
+    if (!callData->args[0].isNullOrUndefined() && !callData->args[0].as<TimeoutObject>())
+        return m_v4->throwTypeError("clearTimeout: argument must be a Timeout object");
 
-    const int timerId = callData->args[0].toInt32();
-    if (m_timeoutCallbacks.contains(timerId)) {
-        killTimer(timerId);
-        m_timeoutCallbacks.remove(timerId);
-    }
+    QV4::Scope scope(ctx);
+    QV4::Scoped<TimeoutObject> timer(scope, callData->args[0].as<TimeoutObject>());
+    if (timer)
+        disarmTimer(timer->d());
 
     return QV4::Encode::undefined();
 }
@@ -203,14 +462,7 @@ QV4::ReturnedValue EnginePrivate::setInterval(QV4::CallContext *ctx)
     if (delay <= 0)
         delay = 1;
 
-    const int timerId = startTimer(delay, Qt::PreciseTimer);
-    if (!timerId)
-        return m_v4->throwError("setInterval: cannot start timer");
-
-    m_intervalCallbacks.insert(timerId, cb.asReturnedValue());
-
-    /// TODO: Return an object similar to Node's
-    return QV4::Encode(timerId);
+    return addTimer(ctx, cb.getPointer(), delay, true);
 }
 
 QV4::ReturnedValue EnginePrivate::clearInterval(QV4::CallContext *ctx)
@@ -219,13 +471,61 @@ QV4::ReturnedValue EnginePrivate::clearInterval(QV4::CallContext *ctx)
     if (callData->argc < 1)
         return m_v4->throwError("clearInterval: missing arguments");
 
-    if (!callData->args[0].isNumber())
-        return m_v4->throwTypeError("clearInterval: timeout must be an integer (at the moment)");
+    if (!callData->args[0].isNullOrUndefined() && !callData->args[0].as<TimeoutObject>())
+        return m_v4->throwTypeError("clearInterval: argument must be a Timeout object");
+
+    QV4::Scope scope(ctx);
+    QV4::Scoped<TimeoutObject> timer(scope, callData->args[0].as<TimeoutObject>());
+    if (timer)
+        disarmTimer(timer->d());
 
-    const int timerId = callData->args[0].toInt32();
-    if (!m_intervalCallbacks.contains(timerId)) {
-        killTimer(timerId);
-        m_intervalCallbacks.remove(timerId);
+    return QV4::Encode::undefined();
+}
+
+QV4::ReturnedValue EnginePrivate::setImmediate(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    if (!callData->argc)
+        return m_v4->throwError("setImmediate: missing arguments");
+
+    QV4::Scope scope(ctx);
+    QV4::ScopedFunctionObject cb(scope, callData->args[0].asFunctionObject());
+
+    if (!cb)
+        return m_v4->throwTypeError("setImmediate: callback must be a function");
+
+    QV4::ScopedArrayObject arguments(scope);
+    QV4::ScopedValue v(scope);
+
+    if (callData->argc > 1) {
+        arguments = m_v4->newArrayObject();
+        for (int i = 1; i < callData->argc; ++i)
+            arguments->push_back((v = callData->args[i]));
+    }
+
+    QV4::Scoped<ImmediateObject> immediate(scope, m_v4->memoryManager->alloc<ImmediateObject>(
+                                               m_v4, cb.getPointer(), arguments.getPointer()));
+    m_immediateQueue.enqueue(immediate.asReturnedValue());
+    updateImmediateRef(immediate->d());
+    postImmediateEvent();
+
+    return immediate.asReturnedValue();
+}
+
+QV4::ReturnedValue EnginePrivate::clearImmediate(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    if (callData->argc < 1)
+        return m_v4->throwError("clearImmediate: missing arguments");
+
+    if (!callData->args[0].isNullOrUndefined() && !callData->args[0].as<ImmediateObject>())
+        return m_v4->throwTypeError("clearImmediate: argument must be an Immediate object");
+
+    QV4::Scope scope(ctx);
+    QV4::Scoped<ImmediateObject> immediate(scope, callData->args[0].as<ImmediateObject>());
+    if (immediate) {
+        immediate->d()->active = false;
+        updateImmediateRef(immediate->d());
     }
 
     return QV4::Encode::undefined();
@@ -235,67 +535,415 @@ QV4::ReturnedValue EnginePrivate::nextTick(QV4::CallContext *ctx)
 {
     NODE_CTX_CALLDATA(ctx);
     if (!callData->argc)
-        return m_v4->throwError("setInterval: missing arguments");
+        return m_v4->throwError("nextTick: missing arguments");
 
     QV4::Scope scope(ctx);
     QV4::ScopedFunctionObject cb(scope, callData->args[0].asFunctionObject());
 
     if (!cb)
-        return m_v4->throwTypeError("setInterval: callback must be a function");
+        return m_v4->throwTypeError("nextTick: callback must be a function");
+
+    QV4::ScopedArrayObject arguments(scope);
+    QV4::ScopedValue v(scope);
+
+    if (callData->argc > 1) {
+        arguments = m_v4->newArrayObject();
+        for (int i = 1; i < callData->argc; ++i)
+            arguments->push_back((v = callData->args[i]));
+    }
 
-    NextTickEvent *e = new NextTickEvent(cb.asReturnedValue());
-    qApp->postEvent(this, e, INT_MAX);
+    m_tickQueue.enqueue(cb.asReturnedValue());
+    m_tickQueue.enqueue(arguments.asReturnedValue());
+
+    // One event drains every tick queued until it is delivered
+    if (!m_tickEventPosted) {
+        m_tickEventPosted = true;
+        qApp->postEvent(this, new NextTickEvent(), INT_MAX);
+    }
 
     return QV4::Encode::undefined();
 }
 
-QV4::ReturnedValue EnginePrivate::throwErrnoException(int errorNo, const QString &syscall)
+EnginePrivate::TickStatistics EnginePrivate::tickStatistics() const
+{
+    return m_tickStatistics;
+}
+
+void EnginePrivate::adjustExternalMemory(qint64 delta)
+{
+    m_externalMemory += delta;
+}
+
+// The GC only sees the small wrappers, not the payloads they keep alive, so a
+// collection is forced once enough external memory has piled up. Must only be
+// called where a regular allocation could run the GC as well.
+void EnginePrivate::checkExternalMemoryPressure()
+{
+    if (m_externalMemory < m_externalMemoryLimit)
+        return;
+
+    qCDebug(logCategory) << "External memory pressure, collecting at" << m_externalMemory << "bytes";
+    m_v4->memoryManager->runGC();
+    m_externalMemoryLimit = m_externalMemory + qMax(MinExternalMemoryGrowth, m_externalMemory / 2);
+}
+
+QV4::ReturnedValue EnginePrivate::newErrnoException(int errorNo, const QString &syscall, const QString &path)
 {
     const QString message = QString::fromLocal8Bit(strerror(errorNo));
+    return m_v4->memoryManager->alloc<ErrnoExceptionObject>(m_v4, message, errorNo, syscall, path)->asReturnedValue();
+}
 
+QV4::ReturnedValue EnginePrivate::throwErrnoException(int errorNo, const QString &syscall, const QString &path)
+{
     QV4::Scope scope(m_v4);
-    QV4::ScopedObject o(scope, m_v4->memoryManager->alloc<ErrnoExceptionObject>(m_v4, message, errorNo, syscall));
+    QV4::ScopedObject o(scope, newErrnoException(errorNo, syscall, path));
     return m_v4->throwError(o);
 }
 
+void EnginePrivate::queueWork(AsyncWork *work)
+{
+    refHandle();
+#ifdef NODEQML_IO_URING
+    if (m_ioUring && m_ioUring->queue(work))
+        return;
+#endif
+    m_workerPool.start(new WorkRunnable(this, work));
+}
+
+// Completions are batched: only the first one of a batch posts an event
+void EnginePrivate::completeWork(AsyncWork *work)
+{
+    QMutexLocker locker(&m_completedWorkMutex);
+    m_completedWork.append(work);
+    if (m_completedWork.size() == 1)
+        qApp->postEvent(this, new WorkCompletedEvent());
+}
+
+void EnginePrivate::processCompletedWork()
+{
+    QVector<AsyncWork *> completed;
+    {
+        QMutexLocker locker(&m_completedWorkMutex);
+        completed.swap(m_completedWork);
+    }
+
+    QV4::Scope scope(m_v4);
+    QV4::ScopedFunctionObject callback(scope);
+    QV4::ScopedArrayObject arguments(scope);
+    QV4::ScopedValue v(scope);
+
+    for (AsyncWork *work : completed) {
+        callback = work->callback();
+        arguments = m_v4->newArrayObject();
+        if (work->errorNo()) {
+            arguments->push_back((v = newErrnoException(work->errorNo(), work->syscall(), work->path())));
+        } else {
+            arguments->push_back((v = QV4::Primitive::nullValue()));
+            work->appendResults(m_v4, arguments);
+        }
+        delete work;
+
+        if (callback)
+            invokeCallback(callback.getPointer(), arguments.getPointer());
+        unrefHandle();
+    }
+}
+
+QV4::ReturnedValue EnginePrivate::newBuffer(QByteArray *data)
+{
+    QV4::Scope scope(m_v4);
+    checkExternalMemoryPressure();
+    QV4::Scoped<BufferObject> buffer(scope, m_v4->memoryManager->alloc<BufferObject>(m_v4, data));
+    return buffer.asReturnedValue();
+}
+
+QV4::ReturnedValue EnginePrivate::newBuffer(char *data, size_t length, BufferCleanupFunction cleanupFunction, void *cleanupInfo)
+{
+    QV4::Scope scope(m_v4);
+    checkExternalMemoryPressure();
+    QV4::Scoped<BufferObject> buffer(scope, m_v4->memoryManager->alloc<BufferObject>(m_v4, data, length, cleanupFunction, cleanupInfo));
+    return buffer.asReturnedValue();
+}
+
 void EnginePrivate::customEvent(QEvent *event)
 {
-    if (event->type() != NextTickEvent::eventType()) {
+    if (event->type() == NextTickEvent::eventType()) {
+        event->accept();
+
+        EventLoopMonitor::ActiveScope active(m_loopMonitor);
+        m_tickEventPosted = false;
+        processTicks();
+    } else if (event->type() == ImmediateEvent::eventType()) {
+        event->accept();
+
+        EventLoopMonitor::ActiveScope active(m_loopMonitor);
+        m_immediateEventPosted = false;
+        processImmediates();
+    } else if (event->type() == WorkCompletedEvent::eventType()) {
+        event->accept();
+
+        EventLoopMonitor::ActiveScope active(m_loopMonitor);
+        processCompletedWork();
+    } else {
         QObject::customEvent(event);
+    }
+}
+
+void EnginePrivate::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_wheelTimer.timerId()) {
+        QObject::timerEvent(event);
         return;
     }
 
     event->accept();
 
-    NextTickEvent *e = reinterpret_cast<NextTickEvent *>(event);
-    QV4::Scope scope(m_v4);
-    QV4::ScopedFunctionObject cb(scope, e->callback());
-    QV4::ScopedCallData callData(scope, 0);
-    callData->thisObject = m_v4->globalObject->asReturnedValue();
-    cb->call(callData);
+    EventLoopMonitor::ActiveScope active(m_loopMonitor);
+    m_wheelTimer.stop();
+
+    // Immediates queued before the timers expired run first
+    if (!m_immediateQueue.isEmpty())
+        processImmediates();
+    processTimers();
 }
 
-void EnginePrivate::timerEvent(QTimerEvent *event)
+QV4::ReturnedValue EnginePrivate::addTimer(QV4::CallContext *ctx, QV4::FunctionObject *callback,
+                                           int delay, bool repeat)
 {
-    const int timerId = event->timerId();
+    NODE_CTX_CALLDATA(ctx);
 
+    QV4::Scope scope(ctx);
+    QV4::ScopedArrayObject arguments(scope);
+    QV4::ScopedValue v(scope);
+
+    if (callData->argc > 2) {
+        arguments = m_v4->newArrayObject();
+        for (int i = 2; i < callData->argc; ++i)
+            arguments->push_back((v = callData->args[i]));
+    }
+
+    QV4::Scoped<TimeoutObject> timer(scope, m_v4->memoryManager->alloc<TimeoutObject>(
+                                         m_v4, callback, delay, repeat, arguments.getPointer()));
+    armTimer(timer->d());
+    return timer.asReturnedValue();
+}
+
+void EnginePrivate::armTimer(Heap::TimeoutObject *timer)
+{
+    if (!timer->active) {
+        timer->active = true;
+        timer->keepAlive = QV4::Value::fromHeapObject(timer).asReturnedValue();
+    }
+
+    m_timerWheel.schedule(timer, m_clock.elapsed() + timer->delay);
+    updateTimerRef(timer);
+    updateWheelTimer();
+}
+
+void EnginePrivate::disarmTimer(Heap::TimeoutObject *timer)
+{
+    m_timerWheel.cancel(timer);
+
+    if (timer->active) {
+        timer->active = false;
+        timer->keepAlive = QV4::Encode::undefined();
+    }
+
+    updateTimerRef(timer);
+}
+
+void EnginePrivate::updateTimerRef(Heap::TimeoutObject *timer)
+{
+    const bool counted = timer->active && timer->hasRef;
+    if (counted == timer->counted)
+        return;
+
+    timer->counted = counted;
+    if (counted)
+        refHandle();
+    else
+        unrefHandle();
+}
+
+void EnginePrivate::updateImmediateRef(Heap::ImmediateObject *immediate)
+{
+    const bool counted = immediate->active && immediate->hasRef;
+    if (counted == immediate->counted)
+        return;
+
+    immediate->counted = counted;
+    if (counted)
+        refHandle();
+    else
+        unrefHandle();
+}
+
+bool EnginePrivate::isAlive() const
+{
+    return m_activeHandles > 0 || !m_tickQueue.isEmpty();
+}
+
+void EnginePrivate::refHandle()
+{
+    ++m_activeHandles;
+}
+
+void EnginePrivate::unrefHandle()
+{
+    Q_ASSERT(m_activeHandles > 0);
+    if (!--m_activeHandles)
+        scheduleAliveCheck();
+}
+
+void EnginePrivate::scheduleAliveCheck()
+{
+    if (m_aliveCheckPending)
+        return;
+
+    m_aliveCheckPending = true;
+    QMetaObject::invokeMethod(this, "checkAlive", Qt::QueuedConnection);
+}
+
+void EnginePrivate::checkAlive()
+{
+    Q_Q(Engine);
+
+    m_aliveCheckPending = false;
+    if (!isAlive())
+        emit q->drained();
+}
+
+void EnginePrivate::processTicks()
+{
     QV4::Scope scope(m_v4);
     QV4::ScopedFunctionObject cb(scope);
+    QV4::ScopedArrayObject arguments(scope);
+
+    // Ticks queued by the callbacks themselves run in the same pass
+    uint count = 0;
+    while (!m_tickQueue.isEmpty()) {
+        cb = m_tickQueue.dequeue();
+        arguments = m_tickQueue.dequeue();
+        invokeCallback(cb.getPointer(), arguments.getPointer());
+        ++count;
+    }
 
-    if (m_timeoutCallbacks.contains(timerId)) {
-        killTimer(timerId);
-        cb = m_timeoutCallbacks.take(timerId);
-    } else if (m_intervalCallbacks.contains(timerId)) {
-        cb = m_intervalCallbacks.value(timerId);
-    } else {
+    ++m_tickStatistics.drains;
+    m_tickStatistics.ticks += count;
+    m_tickStatistics.lastDrain = count;
+    m_tickStatistics.maxDrain = qMax(m_tickStatistics.maxDrain, count);
+
+    if (!isAlive())
+        scheduleAliveCheck();
+}
+
+void EnginePrivate::processImmediates()
+{
+    QV4::Scope scope(m_v4);
+    QV4::Scoped<ImmediateObject> immediate(scope);
+
+    // Immediates queued by the callbacks themselves wait for the next pass
+    uint count = m_immediateQueue.size();
+    while (count--) {
+        immediate = m_immediateQueue.dequeue();
+        if (!immediate->d()->active)
+            continue;
+
+        immediate->d()->active = false;
+        updateImmediateRef(immediate->d());
+        invokeCallback(immediate->d()->callback, immediate->d()->arguments);
+    }
+
+    if (!m_immediateQueue.isEmpty())
+        postImmediateEvent();
+    else if (!isAlive())
+        scheduleAliveCheck();
+}
+
+void EnginePrivate::postImmediateEvent()
+{
+    if (m_immediateEventPosted)
+        return;
+
+    // Low priority lets already pending I/O and timer events go first
+    m_immediateEventPosted = true;
+    qApp->postEvent(this, new ImmediateEvent(), Qt::LowEventPriority);
+}
+
+void EnginePrivate::processTimers()
+{
+    m_timerWheel.update(m_clock.elapsed());
+
+    QV4::Scope scope(m_v4);
+    QV4::Scoped<TimeoutObject> timer(scope);
+
+    while (TimerWheel::Node *node = m_timerWheel.takeExpired()) {
+        timer = QV4::Value::fromHeapObject(static_cast<Heap::TimeoutObject *>(node));
+        invokeCallback(timer->d()->callback, timer->d()->arguments);
+
+        // Cleared or refreshed from its own callback
+        if (!timer->d()->active || timer->d()->isPending())
+            continue;
+
+        if (timer->d()->repeat)
+            m_timerWheel.schedule(timer->d(), m_clock.elapsed() + timer->d()->delay);
+        else
+            disarmTimer(timer->d());
+    }
+
+    updateWheelTimer();
+}
+
+void EnginePrivate::updateWheelTimer()
+{
+    const qint64 nextExpiry = m_timerWheel.nextExpiry();
+    if (nextExpiry < 0) {
+        m_wheelTimer.stop();
         return;
     }
 
-    event->accept();
+    if (m_wheelTimer.isActive() && m_wheelTimerDeadline <= nextExpiry)
+        return;
+
+    m_wheelTimerDeadline = nextExpiry;
+    const qint64 interval = qBound<qint64>(0, nextExpiry - m_clock.elapsed(), INT_MAX);
+    m_wheelTimer.start(interval, Qt::PreciseTimer, this);
+}
 
-    QV4::ScopedCallData callData(scope, 0);
+void EnginePrivate::invokeCallback(QV4::FunctionObject *callback, QV4::ArrayObject *arguments)
+{
+    QV4::Scope scope(m_v4);
+    QV4::ScopedFunctionObject cb(scope, callback);
+    QV4::ScopedArrayObject args(scope, arguments);
+
+    const uint argc = args ? args->getLength() : 0;
+    QV4::ScopedCallData callData(scope, argc);
     callData->thisObject = m_v4->globalObject->asReturnedValue();
-    QV4::SimpleScriptFunction::call(cb, callData);
+    for (uint i = 0; i < argc; ++i)
+        callData->args[i] = args->getIndexed(i);
+
+    cb->call(callData);
+
+    if (m_v4->hasException)
+        reportException();
+}
+
+void EnginePrivate::reportException()
+{
+    QV4::Scope scope(m_v4);
+    QV4::ScopedString s(scope);
+
+    QV4::StackTrace stackTrace;
+    QV4::ScopedValue exception(scope, m_v4->catchException(&stackTrace));
+    QV4::ScopedObject ex(scope, exception);
+    if (ex)
+        exception = ex->get(s = m_v4->newString(QStringLiteral("message")));
+
+    qCWarning(logCategory, "Uncaught exception: %s", qPrintable(exception->toQStringNoThrow()));
+    foreach (const QV4::StackFrame &frame, stackTrace) {
+        qCWarning(logCategory, "    at %s (%s:%d:%d)",
+                  qPrintable(frame.function), qPrintable(frame.source), frame.line, frame.column);
+    }
 }
 
 void EnginePrivate::registerTypes()
@@ -312,14 +960,33 @@ void EnginePrivate::registerTypes()
     bufferPrototype->init(m_v4, bufferCtor.asObject());
     bufferClass = QV4::InternalClass::create(m_v4, BufferObject::staticVTable(), bufferPrototype);
 
+    QV4::Scoped<TimeoutPrototype> timeoutPrototype(scope, m_v4->memoryManager->alloc<TimeoutPrototype>(m_v4->objectClass));
+    timeoutPrototype->init(m_v4);
+    timeoutClass = QV4::InternalClass::create(m_v4, TimeoutObject::staticVTable(), timeoutPrototype);
+
+    QV4::Scoped<ImmediatePrototype> immediatePrototype(scope, m_v4->memoryManager->alloc<ImmediatePrototype>(m_v4->objectClass));
+    immediatePrototype->init(m_v4);
+    immediateClass = QV4::InternalClass::create(m_v4, ImmediateObject::staticVTable(), immediatePrototype);
+
+    QV4::Scoped<HistogramPrototype> histogramPrototype(scope, m_v4->memoryManager->alloc<HistogramPrototype>(m_v4->objectClass));
+    histogramPrototype->init(m_v4);
+    histogramClass = QV4::InternalClass::create(m_v4, HistogramObject::staticVTable(), histogramPrototype);
+
+    QV4::Scoped<StatsPrototype> statsPrototype(scope, m_v4->memoryManager->alloc<StatsPrototype>(m_v4->objectClass));
+    statsPrototype->init(m_v4);
+    statsClass = QV4::InternalClass::create(m_v4, StatsObject::staticVTable(), statsPrototype);
+
     m_v4->globalObject->defineDefaultProperty(QStringLiteral("Buffer"), bufferCtor);
     m_v4->globalObject->defineDefaultProperty(QStringLiteral("SlowBuffer"), bufferCtor);
 }
 
 void EnginePrivate::registerModules()
 {
-    m_coreModules.insert(QStringLiteral("fs"), m_v4->memoryManager->alloc<FileSystemModule>(m_v4)->asReturnedValue());
-    m_coreModules.insert(QStringLiteral("os"), m_v4->memoryManager->alloc<OsModule>(m_v4)->asReturnedValue());
-    m_coreModules.insert(QStringLiteral("path"), m_v4->memoryManager->alloc<PathModule>(m_v4)->asReturnedValue());
-    m_coreModules.insert(QStringLiteral("util"), m_v4->memoryManager->alloc<UtilModule>(m_v4)->asReturnedValue());
+    m_moduleFactories.insert(QStringLiteral("console"), createModule<ConsoleModule>);
+    m_moduleFactories.insert(QStringLiteral("fs"), createModule<FileSystemModule>);
+    m_moduleFactories.insert(QStringLiteral("os"), createModule<OsModule>);
+    m_moduleFactories.insert(QStringLiteral("path"), createModule<PathModule>);
+    m_moduleFactories.insert(QStringLiteral("perf_hooks"), createModule<PerfHooksModule>);
+    m_moduleFactories.insert(QStringLiteral("process"), createModule<ProcessModule>);
+    m_moduleFactories.insert(QStringLiteral("util"), createModule<UtilModule>);
 }
@@ -12,6 +12,26 @@ namespace NodeQml {
 
 class EnginePrivate;
 
+// Called with the data and cleanupInfo passed to Engine::newBuffer
+typedef void (*BufferCleanupFunction)(void *data, void *cleanupInfo);
+
+// Times are in nanoseconds
+struct EventLoopStatistics
+{
+    qint64 idleTime = 0;
+    qint64 activeTime = 0;
+    double utilization = 0;
+
+    qint64 delayCount = 0;
+    qint64 delayMin = 0;
+    qint64 delayMax = 0;
+    double delayMean = 0;
+    double delayStddev = 0;
+    qint64 delayP50 = 0;
+    qint64 delayP90 = 0;
+    qint64 delayP99 = 0;
+};
+
 class NODEQMLSHARED_EXPORT Engine : public QObject
 {
     Q_OBJECT
@@ -22,8 +42,28 @@ public:
     QJSValue require(const QString &id);
     /// TODO: QJSValue evaluate(const QString &code);
 
+    // A moved-in QByteArray that nothing else shares is taken over without
+    // copying; any other array is copied, so writes to the Buffer never show
+    // through to QByteArrays.
+    QJSValue newBuffer(QByteArray &&data);
+    QJSValue newBuffer(const QByteArray &data);
+    // Wraps existing memory without copying. cleanupFunction is called from
+    // the engine's thread once the Buffer and all slices of it have been
+    // collected
+    QJSValue newBuffer(char *data, size_t length, BufferCleanupFunction cleanupFunction = nullptr,
+                       void *cleanupInfo = nullptr);
+
     bool hasException() const;
 
+    // False once no referenced timers or pending callbacks are left
+    bool isAlive() const;
+
+    EventLoopStatistics eventLoopStatistics() const;
+    void setEventLoopDelayMonitoringEnabled(bool enabled, int resolution = 10);
+
+signals:
+    void drained();
+
 private:
     EnginePrivate * const d_ptr;
     Q_DECLARE_PRIVATE(Engine)
@@ -1,19 +1,41 @@
 #ifndef ENGINE_P_H
 #define ENGINE_P_H
 
+#include "engine.h"
+#include "util/bufferpool.h"
+#include "util/packageindex.h"
+#include "util/timerwheel.h"
+#include "util/valuequeue.h"
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
 
 #include <private/qv4engine_p.h>
 #include <private/qv4persistent_p.h>
 
+class QFileSystemWatcher;
 class QQmlEngine;
 
 namespace NodeQml {
 
-class Engine;
+class AsyncWork;
+class EventLoopMonitor;
+#ifdef NODEQML_IO_URING
+class IoUring;
+#endif
 struct ModuleObject;
 
+namespace Heap {
+struct ImmediateObject;
+struct TimeoutObject;
+}
+
 class EnginePrivate : public QObject
 {
     Q_OBJECT
@@ -24,7 +46,7 @@ public:
     ~EnginePrivate();
 
     bool hasNativeModule(const QString &id) const;
-    QV4::Object *nativeModule(const QString &id) const;
+    QV4::Object *nativeModule(const QString &id);
 
     void cacheModule(const QString& id, ModuleObject *module);
     bool hasCachedModule(const QString &id) const;
@@ -32,15 +54,62 @@ public:
 
     QV4::ReturnedValue require(const QString &id, QV4::ExecutionContext *ctx = nullptr);
 
+    // Resolution results keyed by (absolute parent directory, request); misses are
+    // cached as empty strings only while module paths are watched
+    bool lookupResolvedModule(const QString &parentPath, const QString &request, QString *filename) const;
+    void cacheResolvedModule(const QString &parentPath, const QString &request, const QString &filename);
+    PackageIndex *packageIndex() { return &m_packageIndex; }
+
     QV4::ReturnedValue setTimeout(QV4::CallContext *ctx);
     QV4::ReturnedValue clearTimeout(QV4::CallContext *ctx);
 
     QV4::ReturnedValue setInterval(QV4::CallContext *ctx);
     QV4::ReturnedValue clearInterval(QV4::CallContext *ctx);
 
+    QV4::ReturnedValue setImmediate(QV4::CallContext *ctx);
+    QV4::ReturnedValue clearImmediate(QV4::CallContext *ctx);
+
     QV4::ReturnedValue nextTick(QV4::CallContext *ctx);
 
-    QV4::ReturnedValue throwErrnoException(int errorNo, const QString &syscall);
+    struct TickStatistics {
+        quint64 drains = 0;
+        quint64 ticks = 0;
+        uint lastDrain = 0;
+        uint maxDrain = 0;
+    };
+
+    TickStatistics tickStatistics() const;
+
+    // Bytes of buffer payload owned by live BufferObjects, outside of the V4 heap
+    qint64 externalMemory() const { return m_externalMemory; }
+    void adjustExternalMemory(qint64 delta);
+    void checkExternalMemoryPressure();
+
+    void armTimer(Heap::TimeoutObject *timer);
+    void disarmTimer(Heap::TimeoutObject *timer);
+    void updateTimerRef(Heap::TimeoutObject *timer);
+
+    void updateImmediateRef(Heap::ImmediateObject *immediate);
+
+    bool isAlive() const;
+    void refHandle();
+    void unrefHandle();
+    void scheduleAliveCheck();
+
+    EventLoopMonitor *loopMonitor() const { return m_loopMonitor; }
+    BufferPool *bufferPool() { return &m_bufferPool; }
+
+    QV4::ReturnedValue newErrnoException(int errorNo, const QString &syscall, const QString &path = QString());
+    QV4::ReturnedValue throwErrnoException(int errorNo, const QString &syscall, const QString &path = QString());
+
+    // Runs work on the worker pool and keeps the engine alive until its callback has run
+    void queueWork(AsyncWork *work);
+    // Called from pool threads, and from the engine thread for io_uring work
+    void completeWork(AsyncWork *work);
+
+    // Takes *data over if nothing else shares it, see Heap::BufferObject
+    QV4::ReturnedValue newBuffer(QByteArray *data);
+    QV4::ReturnedValue newBuffer(char *data, size_t length, BufferCleanupFunction cleanupFunction, void *cleanupInfo);
 
 public:
     QV4::Value bufferCtor;
@@ -48,25 +117,79 @@ public:
 
     QV4::InternalClass *errnoExceptionClass;
 
+    QV4::InternalClass *timeoutClass;
+    QV4::InternalClass *immediateClass;
+    QV4::InternalClass *histogramClass;
+    QV4::InternalClass *statsClass;
+
 protected:
     void customEvent(QEvent *event) override;
     void timerEvent(QTimerEvent *event) override;
 
+private slots:
+    void checkAlive();
+    void invalidateResolvedModules();
+
 private:
     Engine * const q_ptr;
     Q_DECLARE_PUBLIC(Engine)
 
+    QV4::ReturnedValue addTimer(QV4::CallContext *ctx, QV4::FunctionObject *callback, int delay, bool repeat);
+    void processTicks();
+    void processImmediates();
+    void postImmediateEvent();
+    void processTimers();
+    void processCompletedWork();
+    void updateWheelTimer();
+
+    void invokeCallback(QV4::FunctionObject *callback, QV4::ArrayObject *arguments = nullptr);
+    void reportException();
+
+    void watchModulePath(const QString &path);
+
     void registerTypes();
     void registerModules();
 
     QQmlEngine *m_qmlEngine;
     QV4::ExecutionEngine *m_v4;
 
+    // Core modules are only instantiated once they are first required
+    typedef QV4::ReturnedValue (*ModuleFactory)(QV4::ExecutionEngine *v4);
+    QHash<QString, ModuleFactory> m_moduleFactories;
     QHash<QString, QV4::PersistentValue> m_coreModules;
     QHash<QString, ModuleObject *> m_cachedModules;
 
-    QHash<int, QV4::PersistentValue> m_timeoutCallbacks;
-    QHash<int, QV4::PersistentValue> m_intervalCallbacks;
+    QHash<QString, QString> m_resolvedModules;
+    PackageIndex m_packageIndex;
+    QFileSystemWatcher *m_moduleWatcher = nullptr;
+    QSet<QString> m_watchedPaths;
+
+    ValueQueue m_tickQueue;
+    bool m_tickEventPosted = false;
+    TickStatistics m_tickStatistics;
+
+    ValueQueue m_immediateQueue;
+    bool m_immediateEventPosted = false;
+
+    QElapsedTimer m_clock;
+    TimerWheel m_timerWheel;
+    QBasicTimer m_wheelTimer;
+    qint64 m_wheelTimerDeadline = 0;
+
+    EventLoopMonitor *m_loopMonitor;
+
+    QThreadPool m_workerPool;
+    QMutex m_completedWorkMutex;
+    QVector<AsyncWork *> m_completedWork;
+#ifdef NODEQML_IO_URING
+    IoUring *m_ioUring = nullptr;
+#endif
+    BufferPool m_bufferPool;
+    qint64 m_externalMemory = 0;
+    qint64 m_externalMemoryLimit;
+
+    int m_activeHandles = 0;
+    bool m_aliveCheckPending = false;
 
     static QHash<QV4::ExecutionEngine *, EnginePrivate*> m_nodeEngines;
 };
@@ -0,0 +1,90 @@
+#include "eventloopmonitor.h"
+
+#include <QTimerEvent>
+
+using namespace NodeQml;
+
+EventLoopMonitor::EventLoopMonitor(QObject *parent) :
+    QObject(parent)
+{
+    m_clock.start();
+}
+
+qint64 EventLoopMonitor::activeTime() const
+{
+    if (m_depth)
+        return m_activeTime + now() - m_activeSince;
+    return m_activeTime;
+}
+
+qint64 EventLoopMonitor::idleTime() const
+{
+    return now() - activeTime();
+}
+
+void EventLoopMonitor::enter()
+{
+    // Nested dispatch (e.g. a callback spinning a local event loop) is counted once
+    if (!m_depth++)
+        m_activeSince = now();
+}
+
+void EventLoopMonitor::leave()
+{
+    Q_ASSERT(m_depth > 0);
+    if (!--m_depth)
+        m_activeTime += now() - m_activeSince;
+}
+
+HdrHistogram *EventLoopMonitor::ensureDelayHistogram()
+{
+    if (!m_delayHistogram)
+        m_delayHistogram.reset(new HdrHistogram());
+    return m_delayHistogram.data();
+}
+
+void EventLoopMonitor::startSampling(HdrHistogram *histogram, int resolution)
+{
+    stopSampling(histogram);
+
+    const int timerId = startTimer(qMax(resolution, 1), Qt::PreciseTimer);
+    if (!timerId)
+        return;
+
+    Sampler sampler;
+    sampler.histogram = histogram;
+    sampler.interval = qint64(qMax(resolution, 1)) * 1000000;
+    sampler.lastSample = now();
+    m_samplers.insert(timerId, sampler);
+}
+
+void EventLoopMonitor::stopSampling(const HdrHistogram *histogram)
+{
+    QMutableHashIterator<int, Sampler> it(m_samplers);
+    while (it.hasNext()) {
+        it.next();
+        if (it.value().histogram != histogram)
+            continue;
+        killTimer(it.key());
+        it.remove();
+    }
+}
+
+void EventLoopMonitor::timerEvent(QTimerEvent *event)
+{
+    QHash<int, Sampler>::iterator it = m_samplers.find(event->timerId());
+    if (it == m_samplers.end()) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    event->accept();
+
+    // Lag is how much later than scheduled the sampling timer got to run
+    const qint64 sampleTime = now();
+    const qint64 delay = sampleTime - it->lastSample - it->interval;
+    it->lastSample = sampleTime;
+
+    if (delay > 0)
+        it->histogram->record(delay);
+}
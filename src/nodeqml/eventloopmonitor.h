@@ -0,0 +1,67 @@
+#ifndef EVENTLOOPMONITOR_H
+#define EVENTLOOPMONITOR_H
+
+#include "util/hdrhistogram.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QScopedPointer>
+
+namespace NodeQml {
+
+/// Measures how the Qt event loop is used by the engine: time spent running
+/// JS callbacks (active) versus everything else (idle), and the loop lag seen
+/// by native sampling timers. All times are in nanoseconds.
+class EventLoopMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    class ActiveScope
+    {
+    public:
+        explicit ActiveScope(EventLoopMonitor *monitor) : m_monitor(monitor) { m_monitor->enter(); }
+        ~ActiveScope() { m_monitor->leave(); }
+
+    private:
+        EventLoopMonitor *m_monitor;
+    };
+
+    explicit EventLoopMonitor(QObject *parent = nullptr);
+
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+    qint64 activeTime() const;
+    qint64 idleTime() const;
+
+    void enter();
+    void leave();
+
+    void startSampling(HdrHistogram *histogram, int resolution);
+    void stopSampling(const HdrHistogram *histogram);
+
+    // Null until delay monitoring is first enabled, the histogram being a few hundred KB
+    const HdrHistogram *delayHistogram() const { return m_delayHistogram.data(); }
+    HdrHistogram *ensureDelayHistogram();
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    struct Sampler {
+        HdrHistogram *histogram;
+        qint64 interval;
+        qint64 lastSample;
+    };
+
+    QElapsedTimer m_clock;
+    qint64 m_activeTime = 0;
+    qint64 m_activeSince = 0;
+    int m_depth = 0;
+
+    QHash<int, Sampler> m_samplers;
+    QScopedPointer<HdrHistogram> m_delayHistogram;
+};
+
+} // namespace NodeQml
+
+#endif // EVENTLOOPMONITOR_H
@@ -1,8 +1,6 @@
 #include "globalextensions.h"
 
 #include "engine_p.h"
-#include "modules/process.h"
-#include "modules/console.h"
 
 #include <QQmlEngine>
 
@@ -10,6 +8,46 @@
 
 using namespace NodeQml;
 
+namespace {
+
+// Turns a lazy global into a plain writable data property, so later accesses
+// and assignments no longer go through the accessor
+QV4::ReturnedValue replaceGlobal(QV4::ExecutionEngine *v4, const QString &name, const QV4::Value &value)
+{
+    QV4::Scope scope(v4);
+    QV4::ScopedString s(scope, v4->newString(name));
+    QV4::ScopedValue v(scope, value);
+    QV4::Object *globalObject = v4->globalObject;
+
+    globalObject->deleteProperty(s);
+    globalObject->defineDefaultProperty(s, v);
+    return v->asReturnedValue();
+}
+
+QV4::ReturnedValue lazyGlobalModule(QV4::CallContext *ctx, const QString &name)
+{
+    QV4::ExecutionEngine *v4 = ctx->engine();
+    QV4::Object *module = EnginePrivate::get(v4)->nativeModule(name);
+    if (!module)
+        return v4->throwError(QStringLiteral("Cannot load core module '%1'").arg(name));
+
+    QV4::Scope scope(v4);
+    QV4::ScopedValue v(scope, module->asReturnedValue());
+    return replaceGlobal(v4, name, v);
+}
+
+QV4::ReturnedValue assignLazyGlobal(QV4::CallContext *ctx, const QString &name)
+{
+    NODE_CTX_CALLDATA(ctx);
+    QV4::ExecutionEngine *v4 = ctx->engine();
+    QV4::Scope scope(v4);
+    QV4::ScopedValue v(scope, callData->argc ? callData->args[0].asReturnedValue() : QV4::Encode::undefined());
+    replaceGlobal(v4, name, v);
+    return QV4::Encode::undefined();
+}
+
+}
+
 void GlobalExtensions::init(QQmlEngine *qmlEngine)
 {
     QV4::ExecutionEngine *v4 = QV8Engine::getV4(qmlEngine);
@@ -23,12 +61,12 @@ void GlobalExtensions::init(QQmlEngine *qmlEngine)
     globalObject->defineDefaultProperty(QStringLiteral("setInterval"), method_setInterval);
     globalObject->defineDefaultProperty(QStringLiteral("clearInterval"), method_clearInterval);
 
-    QV4::Scope scope(v4);
-    QV4::ScopedObject process(scope, v4->memoryManager->alloc<ProcessModule>(v4));
-    globalObject->defineDefaultProperty(QStringLiteral("process"), process);
+    globalObject->defineDefaultProperty(QStringLiteral("setImmediate"), method_setImmediate);
+    globalObject->defineDefaultProperty(QStringLiteral("clearImmediate"), method_clearImmediate);
 
-    QV4::ScopedObject console(scope, v4->memoryManager->alloc<ConsoleModule>(v4));
-    globalObject->defineDefaultProperty(QStringLiteral("console"), console);
+    // Built on first access, after which they are ordinary data properties
+    globalObject->defineAccessorProperty(QStringLiteral("process"), property_process_getter, property_process_setter);
+    globalObject->defineAccessorProperty(QStringLiteral("console"), property_console_getter, property_console_setter);
 }
 
 QV4::ReturnedValue GlobalExtensions::method_require(QV4::CallContext *ctx)
@@ -64,3 +102,33 @@ QV4::ReturnedValue GlobalExtensions::method_clearInterval(QV4::CallContext *ctx)
 {
     return EnginePrivate::get(ctx->engine())->clearInterval(ctx);
 }
+
+QV4::ReturnedValue GlobalExtensions::method_setImmediate(QV4::CallContext *ctx)
+{
+    return EnginePrivate::get(ctx->engine())->setImmediate(ctx);
+}
+
+QV4::ReturnedValue GlobalExtensions::method_clearImmediate(QV4::CallContext *ctx)
+{
+    return EnginePrivate::get(ctx->engine())->clearImmediate(ctx);
+}
+
+QV4::ReturnedValue GlobalExtensions::property_process_getter(QV4::CallContext *ctx)
+{
+    return lazyGlobalModule(ctx, QStringLiteral("process"));
+}
+
+QV4::ReturnedValue GlobalExtensions::property_process_setter(QV4::CallContext *ctx)
+{
+    return assignLazyGlobal(ctx, QStringLiteral("process"));
+}
+
+QV4::ReturnedValue GlobalExtensions::property_console_getter(QV4::CallContext *ctx)
+{
+    return lazyGlobalModule(ctx, QStringLiteral("console"));
+}
+
+QV4::ReturnedValue GlobalExtensions::property_console_setter(QV4::CallContext *ctx)
+{
+    return assignLazyGlobal(ctx, QStringLiteral("console"));
+}
@@ -17,6 +17,14 @@ struct GlobalExtensions {
 
     static QV4::ReturnedValue method_setInterval(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_clearInterval(QV4::CallContext *ctx);
+
+    static QV4::ReturnedValue method_setImmediate(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_clearImmediate(QV4::CallContext *ctx);
+
+    static QV4::ReturnedValue property_process_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_process_setter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_console_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_console_setter(QV4::CallContext *ctx);
 };
 
 } // namespace NodeQml
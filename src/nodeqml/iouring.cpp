@@ -0,0 +1,166 @@
+#include "iouring.h"
+
+#include "asyncwork.h"
+#include "engine_p.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QLoggingCategory>
+#include <QSocketNotifier>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace {
+const QLoggingCategory logCategory("nodeqml.iouring");
+}
+
+using namespace NodeQml;
+
+// Posted by the first submission of an event loop turn
+class IoUringSubmitEvent : public QEvent
+{
+public:
+    IoUringSubmitEvent() :
+        QEvent(IoUringSubmitEvent::eventType())
+    {
+
+    }
+
+    static QEvent::Type eventType()
+    {
+        if (m_type == QEvent::None)
+            m_type = static_cast<QEvent::Type>(QEvent::registerEventType());
+        return m_type;
+    }
+
+private:
+    static QEvent::Type m_type;
+};
+
+QEvent::Type IoUringSubmitEvent::m_type = QEvent::None;
+
+IoUring::IoUring(EnginePrivate *engine) :
+    QObject(engine),
+    m_engine(engine)
+{
+    int result = io_uring_queue_init(QueueDepth, &m_ring, 0);
+    if (result < 0) {
+        qCDebug(logCategory) << "io_uring unavailable:" << strerror(-result);
+        return;
+    }
+
+    // Plain IORING_OP_READ/WRITE need Linux 5.6
+    struct io_uring_probe *probe = io_uring_get_probe_ring(&m_ring);
+    const bool supported = probe
+            && io_uring_opcode_supported(probe, IORING_OP_READ)
+            && io_uring_opcode_supported(probe, IORING_OP_WRITE);
+    if (probe)
+        io_uring_free_probe(probe);
+    if (!supported) {
+        qCDebug(logCategory) << "io_uring lacks IORING_OP_READ/WRITE";
+        io_uring_queue_exit(&m_ring);
+        return;
+    }
+
+    m_eventFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_eventFd == -1 || (result = io_uring_register_eventfd(&m_ring, m_eventFd)) < 0) {
+        qCWarning(logCategory) << "Cannot register eventfd:" << strerror(m_eventFd == -1 ? errno : -result);
+        if (m_eventFd != -1)
+            ::close(m_eventFd);
+        io_uring_queue_exit(&m_ring);
+        return;
+    }
+
+    m_notifier = new QSocketNotifier(m_eventFd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &IoUring::processCompletions);
+    m_valid = true;
+}
+
+IoUring::~IoUring()
+{
+    if (!m_valid)
+        return;
+
+    // The kernel may still write into buffers owned by in-flight work
+    submit();
+    while (m_inFlight) {
+        struct io_uring_cqe *cqe;
+        const int result = io_uring_wait_cqe(&m_ring, &cqe);
+        if (result == -EINTR)
+            continue;
+        if (result < 0)
+            break;
+
+        delete static_cast<AsyncWork *>(io_uring_cqe_get_data(cqe));
+        io_uring_cqe_seen(&m_ring, cqe);
+        --m_inFlight;
+    }
+
+    delete m_notifier;
+    io_uring_queue_exit(&m_ring);
+    ::close(m_eventFd);
+}
+
+bool IoUring::queue(AsyncWork *work)
+{
+    if (m_inFlight >= QueueDepth)
+        return false;
+    if (!io_uring_sq_space_left(&m_ring))
+        submit();
+
+    struct io_uring_sqe *sqe = work->prepare(&m_ring);
+    if (!sqe)
+        return false;
+
+    io_uring_sqe_set_data(sqe, work);
+    ++m_inFlight;
+
+    if (!m_submitPosted) {
+        m_submitPosted = true;
+        qApp->postEvent(this, new IoUringSubmitEvent());
+    }
+    return true;
+}
+
+void IoUring::customEvent(QEvent *event)
+{
+    if (event->type() == IoUringSubmitEvent::eventType()) {
+        event->accept();
+
+        m_submitPosted = false;
+        submit();
+    } else {
+        QObject::customEvent(event);
+    }
+}
+
+void IoUring::submit()
+{
+    int result;
+    do {
+        result = io_uring_submit(&m_ring);
+    } while (result == -EINTR);
+
+    if (result < 0)
+        qCWarning(logCategory) << "io_uring_submit failed:" << strerror(-result);
+}
+
+void IoUring::processCompletions()
+{
+    quint64 count;
+    while (::read(m_eventFd, &count, sizeof(count)) == -1 && errno == EINTR) {}
+
+    struct io_uring_cqe *cqe;
+    while (!io_uring_peek_cqe(&m_ring, &cqe)) {
+        AsyncWork *work = static_cast<AsyncWork *>(io_uring_cqe_get_data(cqe));
+        const int result = cqe->res;
+        io_uring_cqe_seen(&m_ring, cqe);
+        --m_inFlight;
+
+        work->complete(result);
+        m_engine->completeWork(work);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef IOURING_H
+#define IOURING_H
+
+#include <QObject>
+
+#include <liburing.h>
+
+class QSocketNotifier;
+
+namespace NodeQml {
+
+class AsyncWork;
+class EnginePrivate;
+
+/// io_uring backend for AsyncWork that maps to a single syscall, such as
+/// positional reads and writes. Everything queued during one event loop turn
+/// is submitted with one io_uring_enter(); the kernel signals completions on
+/// an eventfd watched by a QSocketNotifier, and finished work goes back to the
+/// engine like pool work does. Only built with NODEQML_IO_URING.
+class IoUring : public QObject
+{
+    Q_OBJECT
+public:
+    // Also bounds the operations in flight, so the completion queue never overflows
+    static const unsigned QueueDepth = 256;
+
+    explicit IoUring(EnginePrivate *engine);
+    ~IoUring();
+
+    // False if the kernel lacks io_uring or forbids it (seccomp, sysctl)
+    bool isValid() const { return m_valid; }
+
+    // False if the work has to go to the worker pool instead
+    bool queue(AsyncWork *work);
+
+protected:
+    void customEvent(QEvent *event) override;
+
+private slots:
+    void processCompletions();
+
+private:
+    void submit();
+
+    EnginePrivate *m_engine;
+    struct io_uring m_ring;
+    int m_eventFd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    unsigned m_inFlight = 0;
+    bool m_submitPosted = false;
+    bool m_valid = false;
+};
+
+} // namespace NodeQml
+
+#endif // IOURING_H
@@ -0,0 +1,373 @@
+// fs.ReadStream and fs.WriteStream on top of the asynchronous fs API.
+// Reads go straight into pooled Buffers and are handed out as slices of
+// them, so memory stays bounded by highWaterMark whatever the file size.
+
+var fs = require('fs');
+var util = require('util');
+var Readable = require('stream').Readable;
+var Writable = require('stream').Writable;
+
+var DefaultReadHighWaterMark = 64 * 1024;
+// Below this much free space a new pool is allocated instead of issuing tiny reads
+var MinPoolSpace = 128;
+
+var pool;
+
+function allocNewPool(poolSize) {
+    pool = new Buffer(poolSize);
+    pool.used = 0;
+}
+
+function parseOptions(options, defaults) {
+    if (typeof options === 'string')
+        options = { encoding: options };
+    options = options || {};
+
+    var result = {};
+    var key;
+    for (key in defaults)
+        result[key] = defaults[key];
+    for (key in options)
+        result[key] = options[key];
+    return result;
+}
+
+function openStream(stream) {
+    fs.open(stream.path, stream.flags, stream.mode, function(er, fd) {
+        if (er) {
+            stream.fd = null;
+            if (stream.autoClose)
+                stream.destroy();
+            stream.emit('error', er);
+            return;
+        }
+
+        stream.fd = fd;
+        if (stream.onOpen)
+            stream.onOpen(fd);
+        stream.emit('open', fd);
+    });
+}
+
+function whenOpen(stream, fn) {
+    if (typeof stream.fd === 'number')
+        fn();
+    else
+        stream.once('open', fn);
+}
+
+// A read or write on the descriptor runs on another thread, so closing it
+// meanwhile could fail the request or let it hit a recycled descriptor
+function startIO(stream) {
+    stream._ioPending = true;
+}
+
+function finishIO(stream) {
+    stream._ioPending = false;
+    stream.emit('_ioDone');
+}
+
+function closeStream(stream, err, cb) {
+    if (stream._ioPending) {
+        stream.once('_ioDone', function() {
+            closeStream(stream, err, cb);
+        });
+        return;
+    }
+
+    if (typeof stream.fd !== 'number') {
+        if (stream.fd === null) {
+            cb(err);
+            return;
+        }
+        stream.once('open', function() {
+            closeStream(stream, err, cb);
+        });
+        return;
+    }
+
+    var fd = stream.fd;
+    stream.fd = null;
+    fs.close(fd, function(er) {
+        cb(er || err);
+    });
+}
+
+// ReadStream
+
+function ReadStream(path, options) {
+    if (!(this instanceof ReadStream))
+        return new ReadStream(path, options);
+
+    options = parseOptions(options, {
+        flags: 'r',
+        mode: 438, // 0666
+        autoClose: true,
+        highWaterMark: DefaultReadHighWaterMark
+    });
+
+    Readable.call(this, options);
+
+    this.path = path;
+    this.fd = options.fd === undefined ? undefined : options.fd;
+    this.flags = options.flags;
+    this.mode = options.mode;
+    this.start = options.start;
+    this.end = options.end;
+    this.autoClose = options.autoClose;
+    this.pos = this.start;
+    this.bytesRead = 0;
+
+    if (this.start !== undefined) {
+        if (typeof this.start !== 'number')
+            throw TypeError('start must be a Number');
+        if (this.end === undefined)
+            this.end = Infinity;
+        else if (typeof this.end !== 'number')
+            throw TypeError('end must be a Number');
+        if (this.start > this.end)
+            throw new Error('start must be <= end');
+    }
+
+    if (typeof this.fd === 'number')
+        this.onOpen(this.fd);
+    else
+        openStream(this);
+
+    var self = this;
+    this.on('end', function() {
+        if (self.autoClose)
+            self.destroy();
+    });
+}
+util.inherits(ReadStream, Readable);
+
+// The whole file will be read once, front to back
+ReadStream.prototype.onOpen = function(fd) {
+    fs._fadvise(fd, this.start || 0, 0, 'sequential');
+};
+
+ReadStream.prototype._read = function(n) {
+    if (typeof this.fd !== 'number') {
+        this.once('open', function() {
+            this._read(n);
+        });
+        return;
+    }
+
+    if (this._readableState.destroyed)
+        return;
+
+    if (!pool || pool.length - pool.used < MinPoolSpace)
+        allocNewPool(this._readableState.highWaterMark);
+
+    // The pool is shared by all streams, so the range is reserved up front
+    var thisPool = pool;
+    var toRead = Math.min(pool.length - pool.used, n);
+    var start = pool.used;
+
+    if (this.pos !== undefined)
+        toRead = Math.min(this.end - this.pos + 1, toRead);
+
+    if (toRead <= 0) {
+        this.push(null);
+        return;
+    }
+
+    var self = this;
+    startIO(this);
+    fs.read(this.fd, pool, pool.used, toRead, this.pos === undefined ? null : this.pos, function(er, bytesRead) {
+        finishIO(self);
+        if (self._readableState.destroyed)
+            return;
+
+        if (er) {
+            if (self.autoClose)
+                self.destroy();
+            self.emit('error', er);
+            return;
+        }
+
+        // Hand back what was reserved but not read, unless someone allocated after us
+        if (start + toRead === thisPool.used && thisPool === pool)
+            thisPool.used += bytesRead - toRead;
+
+        if (bytesRead > 0) {
+            self.bytesRead += bytesRead;
+            // Buffer.slice() takes an inclusive end here, unlike node
+            self.push(thisPool.slice(start, start + bytesRead - 1));
+        } else {
+            self.push(null);
+        }
+    });
+
+    if (this.pos !== undefined)
+        this.pos += toRead;
+    pool.used += toRead;
+};
+
+// Piping a file into another file lets the kernel move the bytes between the
+// descriptors (copy_file_range/sendfile), so they never reach a Buffer. Only
+// taken while neither side has started, and the target writes sequentially.
+ReadStream.prototype.pipe = function(dest, options) {
+    var source = this;
+    var state = this._readableState;
+
+    if (!(dest instanceof WriteStream) || dest.pos !== undefined || state.flowing !== null
+            || state.length || this.bytesRead || dest._writableState.length || dest._writableState.ending)
+        return Readable.prototype.pipe.call(this, dest, options);
+
+    var endDest = !options || options.end !== false;
+    var length = this.pos === undefined || this.end === Infinity ? null : this.end - this.pos + 1;
+
+    // Keeps the stream from issuing reads of its own
+    state.flowing = true;
+    state.reading = true;
+
+    whenOpen(source, function() {
+        whenOpen(dest, function() {
+            startIO(source);
+            startIO(dest);
+            fs._copyFd(source.fd, dest.fd, source.pos === undefined ? null : source.pos, length, function(er, bytes) {
+                finishIO(source);
+                finishIO(dest);
+
+                // The target would otherwise never finish or close
+                if (er) {
+                    if (source.autoClose)
+                        source.destroy();
+                    source.emit('error', er);
+                    dest.destroy(er);
+                    return;
+                }
+
+                source.bytesRead += bytes;
+                dest.bytesWritten += bytes;
+                if (source.pos !== undefined)
+                    source.pos += bytes;
+
+                source.push(null);
+                if (endDest)
+                    dest.end();
+            });
+        });
+    });
+
+    dest.emit('pipe', source);
+    return dest;
+};
+
+ReadStream.prototype._destroy = function(err, cb) {
+    closeStream(this, err, cb);
+};
+
+ReadStream.prototype.close = function(cb) {
+    if (cb)
+        this.once('close', cb);
+    this.destroy();
+};
+
+// WriteStream
+
+function WriteStream(path, options) {
+    if (!(this instanceof WriteStream))
+        return new WriteStream(path, options);
+
+    options = parseOptions(options, {
+        flags: 'w',
+        mode: 438, // 0666
+        autoClose: true
+    });
+
+    Writable.call(this, options);
+
+    this.path = path;
+    this.fd = options.fd === undefined ? undefined : options.fd;
+    this.flags = options.flags;
+    this.mode = options.mode;
+    this.start = options.start;
+    this.autoClose = options.autoClose;
+    this.pos = this.start;
+    this.bytesWritten = 0;
+
+    if (this.start !== undefined) {
+        if (typeof this.start !== 'number')
+            throw TypeError('start must be a Number');
+        if (this.start < 0)
+            throw new Error('start must be >= zero');
+    }
+
+    if (typeof this.fd !== 'number')
+        openStream(this);
+
+    var self = this;
+    this.on('finish', function() {
+        if (self.autoClose)
+            self.destroy();
+    });
+}
+util.inherits(WriteStream, Writable);
+
+WriteStream.prototype._write = function(data, encoding, cb) {
+    if (typeof this.fd !== 'number') {
+        this.once('open', function() {
+            this._write(data, encoding, cb);
+        });
+        return;
+    }
+
+    var self = this;
+    var offset = 0;
+
+    // A single write may be partial, e.g. with the io_uring backend
+    function writeSome() {
+        startIO(self);
+        fs.write(self.fd, data, offset, data.length - offset, self.pos === undefined ? null : self.pos,
+                 function(er, bytes) {
+            finishIO(self);
+            if (self._writableState.destroyed)
+                return;
+
+            // Writable destroys the stream on errors
+            if (er) {
+                cb(er);
+                return;
+            }
+
+            offset += bytes;
+            self.bytesWritten += bytes;
+            if (self.pos !== undefined)
+                self.pos += bytes;
+
+            if (offset < data.length)
+                writeSome();
+            else
+                cb();
+        });
+    }
+
+    writeSome();
+};
+
+WriteStream.prototype._destroy = function(err, cb) {
+    closeStream(this, err, cb);
+};
+
+WriteStream.prototype.close = function(cb) {
+    if (cb)
+        this.once('close', cb);
+    this.destroy();
+};
+
+WriteStream.prototype.destroySoon = WriteStream.prototype.end;
+
+exports.ReadStream = ReadStream;
+exports.WriteStream = WriteStream;
+
+exports.createReadStream = function(path, options) {
+    return new ReadStream(path, options);
+};
+
+exports.createWriteStream = function(path, options) {
+    return new WriteStream(path, options);
+};
@@ -0,0 +1,513 @@
+// A reduced take on node's streams: Readable and Writable with
+// highWaterMark based buffering and backpressure, flowing and paused modes,
+// pipe() and destroy(). Object mode, Duplex and Transform are not provided.
+
+var EventEmitter = require('events');
+var util = require('util');
+
+var DefaultHighWaterMark = 16 * 1024;
+
+function chunkLength(chunk) {
+    return chunk.length;
+}
+
+// Number of bytes at the end of buffer that start a character (or base64
+// group) which continues in the next chunk
+function incompleteTail(buffer, encoding) {
+    var length = buffer.length;
+
+    switch (encoding) {
+    case 'utf8':
+    case 'utf-8':
+        for (var i = 1; i <= Math.min(3, length); i++) {
+            var byte = buffer[length - i];
+            if ((byte & 0xC0) === 0x80)
+                continue;
+            var needed = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+            return needed > i ? i : 0;
+        }
+        return 0;
+    case 'ucs2':
+    case 'ucs-2':
+    case 'utf16le':
+    case 'utf-16le':
+        return length % 2;
+    case 'base64':
+        return length % 3;
+    default:
+        return 0;
+    }
+}
+
+// Decodes a sequence of Buffers like string_decoder does, so characters split
+// across chunk boundaries are not mangled
+function Decoder(encoding) {
+    this.encoding = encoding;
+    this.normalized = String(encoding).toLowerCase();
+    this.pending = null;
+}
+
+Decoder.prototype.write = function(buffer) {
+    if (this.pending) {
+        buffer = Buffer.concat([this.pending, buffer]);
+        this.pending = null;
+    }
+
+    var keep = incompleteTail(buffer, this.normalized);
+    if (keep) {
+        // Copied, as the caller may reuse its buffer
+        this.pending = new Buffer(keep);
+        buffer.copy(this.pending, 0, buffer.length - keep);
+        if (keep === buffer.length)
+            return '';
+        // Buffer.toString() takes an inclusive end here
+        return buffer.toString(this.encoding, 0, buffer.length - keep - 1);
+    }
+    return buffer.toString(this.encoding);
+};
+
+// Whatever is left is an incomplete character and decodes as such
+Decoder.prototype.end = function() {
+    var pending = this.pending;
+    this.pending = null;
+    return pending ? pending.toString(this.encoding) : '';
+};
+
+function Stream() {
+    EventEmitter.call(this);
+}
+util.inherits(Stream, EventEmitter);
+
+module.exports = Stream;
+Stream.Stream = Stream;
+
+// Readable
+
+function ReadableState(options) {
+    this.highWaterMark = options.highWaterMark !== undefined ? options.highWaterMark : DefaultHighWaterMark;
+    this.encoding = options.encoding || null;
+    this.decoder = this.encoding ? new Decoder(this.encoding) : null;
+    this.buffer = [];
+    this.length = 0;
+    this.flowing = null;
+    this.reading = false;
+    this.ended = false;
+    this.endEmitted = false;
+    this.flowScheduled = false;
+    this.destroyed = false;
+}
+
+function Readable(options) {
+    if (!(this instanceof Readable))
+        return new Readable(options);
+
+    options = options || {};
+    this._readableState = new ReadableState(options);
+    this.readable = true;
+
+    if (typeof options.read === 'function')
+        this._read = options.read;
+    if (typeof options.destroy === 'function')
+        this._destroy = options.destroy;
+
+    Stream.call(this);
+}
+util.inherits(Readable, Stream);
+
+Stream.Readable = Readable;
+
+Readable.prototype._read = function(n) {
+    this.emit('error', new Error('_read() is not implemented'));
+};
+
+// Returns false once the buffered data reaches highWaterMark; callers should
+// then stop producing until _read() is called again
+Readable.prototype.push = function(chunk, encoding) {
+    var state = this._readableState;
+    state.reading = false;
+
+    if (state.destroyed)
+        return false;
+
+    if (chunk === null) {
+        if (state.decoder && !state.ended) {
+            var rest = state.decoder.end();
+            if (rest.length) {
+                state.buffer.push(rest);
+                state.length += rest.length;
+            }
+        }
+        state.ended = true;
+        scheduleFlow(this);
+        return false;
+    }
+
+    if (typeof chunk === 'string')
+        chunk = new Buffer(chunk, encoding || 'utf8');
+    if (state.decoder)
+        chunk = state.decoder.write(chunk);
+
+    if (chunkLength(chunk)) {
+        state.buffer.push(chunk);
+        state.length += chunkLength(chunk);
+    }
+    scheduleFlow(this);
+
+    return state.length < state.highWaterMark;
+};
+
+Readable.prototype.unshift = function(chunk) {
+    var state = this._readableState;
+    state.buffer.unshift(chunk);
+    state.length += chunkLength(chunk);
+};
+
+// Returns the next buffered chunk, or null if none is available yet
+Readable.prototype.read = function() {
+    var state = this._readableState;
+    var chunk = null;
+
+    if (state.buffer.length) {
+        chunk = state.buffer.shift();
+        state.length -= chunkLength(chunk);
+    }
+
+    maybeRead(this);
+    if (state.ended && !state.length)
+        scheduleFlow(this);
+
+    return chunk;
+};
+
+Readable.prototype.setEncoding = function(encoding) {
+    this._readableState.encoding = encoding;
+    this._readableState.decoder = new Decoder(encoding);
+    return this;
+};
+
+Readable.prototype.isPaused = function() {
+    return this._readableState.flowing === false;
+};
+
+Readable.prototype.pause = function() {
+    if (this._readableState.flowing !== false) {
+        this._readableState.flowing = false;
+        this.emit('pause');
+    }
+    return this;
+};
+
+Readable.prototype.resume = function() {
+    var state = this._readableState;
+    if (!state.flowing) {
+        state.flowing = true;
+        this.emit('resume');
+        scheduleFlow(this);
+    }
+    return this;
+};
+
+Readable.prototype.on = function(type, listener) {
+    var result = Stream.prototype.on.call(this, type, listener);
+
+    // Attaching a 'data' listener switches into flowing mode unless paused explicitly
+    if (type === 'data' && this._readableState.flowing !== false)
+        this.resume();
+    else if (type === 'readable')
+        scheduleFlow(this);
+
+    return result;
+};
+Readable.prototype.addListener = Readable.prototype.on;
+
+Readable.prototype.pipe = function(dest, options) {
+    var source = this;
+    var endDest = !options || options.end !== false;
+
+    function ondata(chunk) {
+        if (dest.write(chunk) === false)
+            source.pause();
+    }
+
+    function ondrain() {
+        source.resume();
+    }
+
+    function onend() {
+        if (endDest)
+            dest.end();
+    }
+
+    function cleanup() {
+        source.removeListener('data', ondata);
+        source.removeListener('end', onend);
+        source.removeListener('end', cleanup);
+        source.removeListener('close', cleanup);
+        dest.removeListener('drain', ondrain);
+        dest.removeListener('close', cleanup);
+        dest.removeListener('finish', cleanup);
+    }
+
+    source.on('data', ondata);
+    source.on('end', onend);
+    source.on('end', cleanup);
+    source.on('close', cleanup);
+    dest.on('drain', ondrain);
+    dest.on('close', cleanup);
+    dest.on('finish', cleanup);
+
+    dest.emit('pipe', source);
+    source.resume();
+    return dest;
+};
+
+Readable.prototype.destroy = function(err) {
+    var self = this;
+    var state = this._readableState;
+    if (state.destroyed)
+        return this;
+
+    state.destroyed = true;
+    state.buffer = [];
+    state.length = 0;
+
+    this._destroy(err || null, function(err) {
+        process.nextTick(function() {
+            if (err)
+                self.emit('error', err);
+            self.emit('close');
+        });
+    });
+    return this;
+};
+
+Readable.prototype._destroy = function(err, cb) {
+    cb(err);
+};
+
+// Pulls from _read() while below highWaterMark, one request at a time
+function maybeRead(stream) {
+    var state = stream._readableState;
+    if (state.reading || state.ended || state.destroyed || state.length >= state.highWaterMark)
+        return;
+
+    state.reading = true;
+    stream._read(state.highWaterMark - state.length);
+}
+
+// Deferred, so that push() from within _read() does not recurse into listeners
+function scheduleFlow(stream) {
+    var state = stream._readableState;
+    if (state.flowScheduled)
+        return;
+
+    state.flowScheduled = true;
+    process.nextTick(function() {
+        state.flowScheduled = false;
+        flow(stream);
+    });
+}
+
+function flow(stream) {
+    var state = stream._readableState;
+    if (state.destroyed)
+        return;
+
+    if (state.flowing) {
+        while (state.flowing && state.buffer.length) {
+            var chunk = state.buffer.shift();
+            state.length -= chunkLength(chunk);
+            stream.emit('data', chunk);
+        }
+    } else if (state.buffer.length || state.ended) {
+        stream.emit('readable');
+    }
+
+    if (state.ended && !state.length) {
+        if (!state.endEmitted) {
+            state.endEmitted = true;
+            stream.readable = false;
+            stream.emit('end');
+        }
+        return;
+    }
+
+    // Paused streams stop issuing reads once highWaterMark is buffered
+    maybeRead(stream);
+}
+
+// Writable
+
+function WritableState(options) {
+    this.highWaterMark = options.highWaterMark !== undefined ? options.highWaterMark : DefaultHighWaterMark;
+    this.defaultEncoding = options.defaultEncoding || 'utf8';
+    this.queue = [];
+    this.length = 0;
+    this.writing = false;
+    this.needDrain = false;
+    this.ending = false;
+    this.finished = false;
+    this.destroyed = false;
+}
+
+function Writable(options) {
+    if (!(this instanceof Writable))
+        return new Writable(options);
+
+    options = options || {};
+    this._writableState = new WritableState(options);
+    this.writable = true;
+
+    if (typeof options.write === 'function')
+        this._write = options.write;
+    if (typeof options.final === 'function')
+        this._final = options.final;
+    if (typeof options.destroy === 'function')
+        this._destroy = options.destroy;
+
+    Stream.call(this);
+}
+util.inherits(Writable, Stream);
+
+Stream.Writable = Writable;
+
+Writable.prototype._write = function(chunk, encoding, cb) {
+    cb(new Error('_write() is not implemented'));
+};
+
+Writable.prototype._final = function(cb) {
+    cb();
+};
+
+// Returns false once highWaterMark bytes are pending; wait for 'drain' then
+Writable.prototype.write = function(chunk, encoding, cb) {
+    var state = this._writableState;
+
+    if (typeof encoding === 'function') {
+        cb = encoding;
+        encoding = null;
+    }
+
+    if (state.ending || state.destroyed) {
+        var er = new Error('write after end');
+        var self = this;
+        process.nextTick(function() {
+            if (cb)
+                cb(er);
+            self.emit('error', er);
+        });
+        return false;
+    }
+
+    if (typeof chunk === 'string')
+        chunk = new Buffer(chunk, encoding || state.defaultEncoding);
+
+    state.length += chunk.length;
+    var ret = state.length < state.highWaterMark;
+    if (!ret)
+        state.needDrain = true;
+
+    state.queue.push({ chunk: chunk, cb: cb });
+    if (!state.writing)
+        writeNext(this);
+
+    return ret;
+};
+
+Writable.prototype.end = function(chunk, encoding, cb) {
+    var state = this._writableState;
+
+    if (typeof chunk === 'function') {
+        cb = chunk;
+        chunk = null;
+    } else if (typeof encoding === 'function') {
+        cb = encoding;
+        encoding = null;
+    }
+
+    if (chunk !== null && chunk !== undefined)
+        this.write(chunk, encoding);
+
+    if (cb)
+        this.once('finish', cb);
+
+    if (!state.ending) {
+        state.ending = true;
+        maybeFinish(this);
+    }
+    return this;
+};
+
+Writable.prototype.destroy = function(err) {
+    var self = this;
+    var state = this._writableState;
+    if (state.destroyed)
+        return this;
+
+    state.destroyed = true;
+    state.queue = [];
+
+    this._destroy(err || null, function(err) {
+        process.nextTick(function() {
+            if (err)
+                self.emit('error', err);
+            self.emit('close');
+        });
+    });
+    return this;
+};
+
+Writable.prototype._destroy = function(err, cb) {
+    cb(err);
+};
+
+function writeNext(stream) {
+    var state = stream._writableState;
+    var entry = state.queue.shift();
+
+    state.writing = true;
+    stream._write(entry.chunk, null, function(err) {
+        state.writing = false;
+        state.length -= entry.chunk.length;
+
+        if (err) {
+            if (entry.cb)
+                entry.cb(err);
+            stream.destroy(err);
+            return;
+        }
+
+        if (entry.cb)
+            entry.cb();
+
+        if (state.destroyed)
+            return;
+
+        if (state.queue.length) {
+            writeNext(stream);
+            return;
+        }
+
+        if (state.needDrain) {
+            state.needDrain = false;
+            stream.emit('drain');
+        }
+        maybeFinish(stream);
+    });
+}
+
+function maybeFinish(stream) {
+    var state = stream._writableState;
+    if (!state.ending || state.writing || state.queue.length || state.finished || state.destroyed)
+        return;
+
+    state.finished = true;
+    stream._final(function(err) {
+        if (err) {
+            stream.destroy(err);
+            return;
+        }
+        stream.writable = false;
+        stream.emit('finish');
+    });
+}
@@ -1,6 +1,7 @@
 #include "moduleobject.h"
 
 #include "engine_p.h"
+#include "util/packageindex.h"
 
 #include <QDir>
 #include <QFile>
@@ -130,6 +131,10 @@ QV4::Object *ModuleObject::compile(QV4::ExecutionContext *ctx)
         return nullptr;
     }
 
+    /// NOTE: Modules are parsed on every load. An on-disk cache of compiled units is not
+    /// possible with this V4: CompiledData::Unit has no serialization, and Moth bytecode
+    /// holds absolute addresses into the interpreter (threaded dispatch), so neither can be
+    /// reloaded in another process. Revisit once QV4 can save/load compilation units.
     QV4::ContextStateSaver ctxSaver(ctx);
     QV4::Script script(v4, global, file->readAll(), d()->filename);
     script.strictMode = v4->currentContext()->d()->strictMode;
@@ -212,34 +217,31 @@ QString ModuleObject::resolveModule(QV4::ExecutionContext *ctx, const QString &r
     if (node->hasNativeModule(request))
         return request;
 
+    QString filename;
+    if (!node->lookupResolvedModule(parentPath, request, &filename)) {
+        filename = findModule(node->packageIndex(), request, parentPath);
+        node->cacheResolvedModule(parentPath, request, filename);
+    }
+    return filename;
+}
+
+QString ModuleObject::findModule(PackageIndex *packages, const QString &request, const QString &parentPath)
+{
     // Bundled JS module
     QFileInfo fi(QStringLiteral(":/js/") + request + QStringLiteral(".js"));
     if (fi.exists())
         return fi.absoluteFilePath();
 
-    /// TODO: .npm_modules
-
-    fi.setFile(request);
-
-    if (fi.isRelative())
-        fi.setFile(QDir(parentPath).filePath(request));
-
-    if (!fi.exists()) {
-        fi.setFile(fi.absoluteFilePath() + QStringLiteral(".js"));
-        if (!fi.exists() || fi.isDir())
-            return QString();
+    if (PackageIndex::isBareSpecifier(request)) {
+        const QString filename = packages->resolve(request, parentPath);
+        if (!filename.isEmpty())
+            return filename;
+        /// NOTE: Unlike node, fall back to a relative path so `nodeqml script.js` keeps working
     }
 
-    if (fi.isFile())
-        return fi.absoluteFilePath();
-
-    // Checking for index file
-    /// TODO: index.[ext]
-    QFileInfo indexInfo(fi.absoluteFilePath() + QStringLiteral("/index.js"));
-    if (indexInfo.exists() && indexInfo.isFile())
-        return indexInfo.absoluteFilePath();
-
-    return QString();
+    if (QDir::isRelativePath(request))
+        return PackageIndex::resolvePath(QDir(parentPath).filePath(request));
+    return PackageIndex::resolvePath(request);
 }
 
 QV4::ReturnedValue ModuleObject::property_filename_getter(QV4::CallContext *ctx)
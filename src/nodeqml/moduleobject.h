@@ -8,6 +8,7 @@
 
 namespace NodeQml {
 
+class PackageIndex;
 struct ModuleObject;
 
 namespace Heap {
@@ -42,6 +43,7 @@ struct ModuleObject : QV4::Object {
 
     static QV4::Object *require(QV4::ExecutionContext *ctx, const QString &path, ModuleObject *parent = nullptr, bool isMain = false);
     static QString resolveModule(QV4::ExecutionContext *ctx, const QString &request, const QString &parentPath = QString());
+    static QString findModule(PackageIndex *packages, const QString &request, const QString &parentPath);
 
     enum {
         ExportsPropertyIndex = 0,
@@ -1,16 +1,888 @@
 #include "filesystem.h"
 
+#include "../asyncwork.h"
 #include "../engine_p.h"
+#include "../moduleobject.h"
+#include "../types/buffer.h"
+#include "../types/stats.h"
 
 #include <QFile>
 #include <QFileInfo>
+#include <QStringList>
 
 #include <private/qv4context_p.h>
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#include <limits>
+
+#ifdef NODEQML_IO_URING
+#include <liburing.h>
+#endif
+
 using namespace NodeQml;
 
+namespace {
+
+// Node's flag strings: r, r+, rs, rs+, w, wx, w+, wx+, a, ax, a+, ax+
+int parseFlags(const QV4::Value &value, int defaultFlags)
+{
+    if (value.isUndefined() || value.isNull())
+        return defaultFlags;
+    if (value.isNumber())
+        return value.toInt32();
+
+    const QString flags = value.toQStringNoThrow();
+    int result = -1;
+    if (flags == QLatin1String("r"))
+        result = O_RDONLY;
+    else if (flags == QLatin1String("rs") || flags == QLatin1String("sr"))
+        result = O_RDONLY | O_SYNC;
+    else if (flags == QLatin1String("r+"))
+        result = O_RDWR;
+    else if (flags == QLatin1String("rs+") || flags == QLatin1String("sr+"))
+        result = O_RDWR | O_SYNC;
+    else if (flags == QLatin1String("w"))
+        result = O_TRUNC | O_CREAT | O_WRONLY;
+    else if (flags == QLatin1String("wx") || flags == QLatin1String("xw"))
+        result = O_TRUNC | O_CREAT | O_WRONLY | O_EXCL;
+    else if (flags == QLatin1String("w+"))
+        result = O_TRUNC | O_CREAT | O_RDWR;
+    else if (flags == QLatin1String("wx+") || flags == QLatin1String("xw+"))
+        result = O_TRUNC | O_CREAT | O_RDWR | O_EXCL;
+    else if (flags == QLatin1String("a"))
+        result = O_APPEND | O_CREAT | O_WRONLY;
+    else if (flags == QLatin1String("ax") || flags == QLatin1String("xa"))
+        result = O_APPEND | O_CREAT | O_WRONLY | O_EXCL;
+    else if (flags == QLatin1String("a+"))
+        result = O_APPEND | O_CREAT | O_RDWR;
+    else if (flags == QLatin1String("ax+") || flags == QLatin1String("xa+"))
+        result = O_APPEND | O_CREAT | O_RDWR | O_EXCL;
+    return result;
+}
+
+// Numbers or octal strings, as in node
+mode_t parseMode(const QV4::Value &value, mode_t defaultMode)
+{
+    if (value.isNumber())
+        return value.toUInt32();
+    if (value.isString()) {
+        bool ok = false;
+        const uint mode = value.toQStringNoThrow().toUInt(&ok, 8);
+        if (ok)
+            return mode;
+    }
+    return defaultMode;
+}
+
+// null and undefined mean the current file position
+inline qint64 parsePosition(const QV4::Value &value)
+{
+    return value.isNumber() && value.toNumber() >= 0 ? qint64(value.toNumber()) : -1;
+}
+
+int openFile(const QByteArray &path, int flags, mode_t mode)
+{
+    int fd;
+    do {
+        fd = ::open(path.constData(), flags | O_CLOEXEC, mode);
+    } while (fd == -1 && errno == EINTR);
+    return fd;
+}
+
+ssize_t readFile(int fd, char *data, size_t length, qint64 position)
+{
+    ssize_t result;
+    do {
+        result = position < 0 ? ::read(fd, data, length) : ::pread(fd, data, length, position);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+// Loops until everything is written, returns -1 on failure
+ssize_t writeFile(int fd, const char *data, size_t length, qint64 position)
+{
+    size_t written = 0;
+    while (written < length) {
+        const ssize_t result = position < 0
+                ? ::write(fd, data + written, length - written)
+                : ::pwrite(fd, data + written, length - written, position + written);
+        if (result == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        written += result;
+    }
+    return written;
+}
+
+// node's fs.constants.COPYFILE_*
+enum CopyFileFlag {
+    CopyFileExcl = 1,
+    CopyFileClone = 2,
+    CopyFileCloneForce = 4
+};
+
+// Chunk size for each kernel copy call, and for the read/write fallback
+const size_t CopyChunkSize = 1024 * 1024;
+
+// Moves length bytes (all of them up to EOF if negative) from the current
+// offset of inFd to that of outFd. The kernel copies the data itself where
+// possible: copy_file_range() lets filesystems share extents or copy on the
+// server side, sendfile() still avoids user space, and plain read/write is
+// the last resort. Returns the number of bytes copied, or -1 with errno set.
+qint64 copyFileData(int inFd, int outFd, qint64 length)
+{
+    enum { CopyFileRange, SendFile, ReadWrite } method = CopyFileRange;
+    QByteArray buffer;
+    qint64 copied = 0;
+
+    while (length < 0 || copied < length) {
+        const size_t chunk = length < 0 ? CopyChunkSize : size_t(qMin<qint64>(length - copied, CopyChunkSize));
+        ssize_t result;
+
+#if defined(Q_OS_LINUX) && defined(SYS_copy_file_range)
+        if (method == CopyFileRange) {
+            result = ::syscall(SYS_copy_file_range, inFd, nullptr, outFd, nullptr, chunk, 0u);
+            // Older kernels, cross-filesystem copies before Linux 5.3, special files
+            if (result == -1 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+                method = SendFile;
+                continue;
+            }
+            // O_APPEND output, which sendfile() rejects as well
+            if (result == -1 && errno == EBADF) {
+                method = ReadWrite;
+                continue;
+            }
+        } else
+#endif
+#ifdef Q_OS_LINUX
+        if (method != ReadWrite) {
+            result = ::sendfile(outFd, inFd, nullptr, chunk);
+            if (result == -1 && (errno == ENOSYS || errno == EINVAL)) {
+                method = ReadWrite;
+                continue;
+            }
+        } else
+#endif
+        {
+            if (buffer.isEmpty())
+                buffer.resize(int(CopyChunkSize));
+            result = readFile(inFd, buffer.data(), chunk, -1);
+            if (result > 0 && writeFile(outFd, buffer.constData(), result, -1) == -1)
+                return -1;
+        }
+
+        if (result == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (!result)
+            break;
+        copied += result;
+    }
+    return copied;
+}
+
+// copyFile() without ever bringing the contents into JS; returns 0 or an errno
+int copyFile(const QByteArray &source, const QByteArray &destination, int flags)
+{
+    const int inFd = openFile(source, O_RDONLY, 0);
+    if (inFd == -1)
+        return errno;
+
+    struct stat st;
+    if (::fstat(inFd, &st) == -1) {
+        const int error = errno;
+        ::close(inFd);
+        return error;
+    }
+
+    // Not truncated yet: the destination may be the source itself
+    const int outFlags = O_WRONLY | O_CREAT | (flags & CopyFileExcl ? O_EXCL : 0);
+    const int outFd = openFile(destination, outFlags, st.st_mode & 0777);
+    if (outFd == -1) {
+        const int error = errno;
+        ::close(inFd);
+        return error;
+    }
+
+    // Copying a file onto itself, or onto a hard link to it, is a no-op as in libuv
+    struct stat outSt;
+    int error = 0;
+    if (::fstat(outFd, &outSt) == -1) {
+        error = errno;
+    } else if (outSt.st_dev == st.st_dev && outSt.st_ino == st.st_ino) {
+        ::close(inFd);
+        ::close(outFd);
+        return 0;
+    } else if (::ftruncate(outFd, 0) == -1) {
+        error = errno;
+    }
+
+    bool cloned = false;
+    if (!error && (flags & (CopyFileClone | CopyFileCloneForce))) {
+#ifdef FICLONE
+        // Shares the extents on copy-on-write filesystems (btrfs, XFS)
+        cloned = ::ioctl(outFd, FICLONE, inFd) == 0;
+        if (!cloned && (flags & CopyFileCloneForce))
+            error = errno;
+#else
+        if (flags & CopyFileCloneForce)
+            error = ENOTSUP;
+#endif
+    }
+
+    if (!cloned && !error && copyFileData(inFd, outFd, -1) == -1)
+        error = errno;
+
+    ::close(inFd);
+    if (::close(outFd) == -1 && !error && errno != EINTR)
+        error = errno;
+    // Like libuv, no partial copy is left behind
+    if (error)
+        ::unlink(destination.constData());
+    return error;
+}
+
+// Holds either a Buffer's storage or an encoded string for the worker thread
+class WriteData
+{
+public:
+    WriteData(const QV4::Value &value, BufferEncoding encoding)
+    {
+        if (const BufferObject *buffer = value.as<BufferObject>()) {
+            m_slice = buffer->d()->data;
+            m_data = m_slice.constData();
+            m_length = m_slice.size();
+        } else {
+            const QString str = value.toQStringNoThrow();
+            m_bytes.resize(int(BufferObject::byteLength(str, encoding)));
+            m_bytes.resize(int(BufferObject::encode(str, encoding, m_bytes.data(), m_bytes.size())));
+            m_data = m_bytes.constData();
+            m_length = m_bytes.size();
+        }
+    }
+
+    WriteData(const QTypedArrayDataSlice<char> &slice, size_t offset, size_t length) :
+        m_slice(slice),
+        m_data(m_slice.constData() + offset),
+        m_length(length)
+    {
+
+    }
+
+    const char *data() const { return m_data; }
+    size_t length() const { return m_length; }
+
+private:
+    QTypedArrayDataSlice<char> m_slice;
+    QByteArray m_bytes;
+    const char *m_data = nullptr;
+    size_t m_length = 0;
+};
+
+class OpenWork : public AsyncWork
+{
+public:
+    OpenWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path, int flags, mode_t mode) :
+        AsyncWork(v4, *callback, QStringLiteral("open"), path),
+        m_file(QFile::encodeName(path)),
+        m_flags(flags),
+        m_mode(mode)
+    {
+
+    }
+
+    void execute() override
+    {
+        m_fd = openFile(m_file, m_flags, m_mode);
+        if (m_fd == -1)
+            setError(errno);
+    }
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope, QV4::Primitive::fromInt32(m_fd));
+        arguments->push_back(v);
+    }
+
+private:
+    QByteArray m_file;
+    int m_flags;
+    mode_t m_mode;
+    int m_fd = -1;
+};
+
+class CloseWork : public AsyncWork
+{
+public:
+    CloseWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, int fd) :
+        AsyncWork(v4, *callback, QStringLiteral("close")),
+        m_fd(fd)
+    {
+
+    }
+
+    void execute() override
+    {
+        // Retrying close() after EINTR may close a reused descriptor
+        if (::close(m_fd) == -1 && errno != EINTR)
+            setError(errno);
+    }
+
+private:
+    int m_fd;
+};
+
+// Reads into the Buffer's memory directly; the slice keeps it alive meanwhile
+class ReadWork : public AsyncWork
+{
+public:
+    ReadWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, int fd, const QV4::Value &buffer,
+             size_t offset, size_t length, qint64 position) :
+        AsyncWork(v4, *callback, QStringLiteral("read")),
+        m_buffer(v4, buffer.asReturnedValue()),
+        m_slice(buffer.as<BufferObject>()->d()->data),
+        m_fd(fd),
+        m_offset(offset),
+        m_length(length),
+        m_position(position)
+    {
+
+    }
+
+    void execute() override
+    {
+        m_bytesRead = readFile(m_fd, m_slice.data() + m_offset, m_length, m_position);
+        if (m_bytesRead == -1)
+            setError(errno);
+    }
+
+#ifdef NODEQML_IO_URING
+    struct io_uring_sqe *prepare(struct io_uring *ring) override
+    {
+        // The result has to fit the completion's int
+        if (m_length > size_t(std::numeric_limits<int>::max()))
+            return nullptr;
+
+        struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+        if (sqe)
+            io_uring_prep_read(sqe, m_fd, m_slice.data() + m_offset, m_length, m_position);
+        return sqe;
+    }
+
+    void complete(int result) override
+    {
+        AsyncWork::complete(result);
+        if (result >= 0)
+            m_bytesRead = result;
+    }
+#endif
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope);
+        arguments->push_back((v = QV4::Primitive::fromDouble(m_bytesRead)));
+        arguments->push_back((v = m_buffer.value()));
+    }
+
+private:
+    QV4::PersistentValue m_buffer;
+    QTypedArrayDataSlice<char> m_slice;
+    int m_fd;
+    size_t m_offset;
+    size_t m_length;
+    qint64 m_position;
+    ssize_t m_bytesRead = 0;
+};
+
+class WriteWork : public AsyncWork
+{
+public:
+    WriteWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, int fd, const QV4::Value &source,
+              const WriteData &data, qint64 position) :
+        AsyncWork(v4, *callback, QStringLiteral("write")),
+        m_source(v4, source.asReturnedValue()),
+        m_data(data),
+        m_fd(fd),
+        m_position(position)
+    {
+
+    }
+
+    void execute() override
+    {
+        m_written = writeFile(m_fd, m_data.data(), m_data.length(), m_position);
+        if (m_written == -1)
+            setError(errno);
+    }
+
+#ifdef NODEQML_IO_URING
+    // A single write, which like node's fs.write() may be partial
+    struct io_uring_sqe *prepare(struct io_uring *ring) override
+    {
+        if (m_data.length() > size_t(std::numeric_limits<int>::max()))
+            return nullptr;
+
+        struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+        if (sqe)
+            io_uring_prep_write(sqe, m_fd, m_data.data(), m_data.length(), m_position);
+        return sqe;
+    }
+
+    void complete(int result) override
+    {
+        AsyncWork::complete(result);
+        if (result >= 0)
+            m_written = result;
+    }
+#endif
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope);
+        arguments->push_back((v = QV4::Primitive::fromDouble(m_written)));
+        arguments->push_back((v = m_source.value()));
+    }
+
+private:
+    QV4::PersistentValue m_source;
+    WriteData m_data;
+    int m_fd;
+    qint64 m_position;
+    ssize_t m_written = 0;
+};
+
+class ReadFileWork : public AsyncWork
+{
+public:
+    ReadFileWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path, int flags,
+                 BufferEncoding encoding) :
+        AsyncWork(v4, *callback, QStringLiteral("open"), path),
+        m_file(QFile::encodeName(path)),
+        m_flags(flags),
+        m_encoding(encoding)
+    {
+
+    }
+
+    void execute() override
+    {
+        const int fd = openFile(m_file, m_flags, 0666);
+        if (fd == -1) {
+            setError(errno);
+            return;
+        }
+
+        // The size is only a hint, files in /proc report 0
+        struct stat st;
+        int capacity = 8192;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            if (st.st_size >= std::numeric_limits<int>::max()) {
+                ::close(fd);
+                setError(EFBIG);
+                return;
+            }
+            capacity = st.st_size + 1;
+        }
+
+        m_contents.resize(capacity);
+        int size = 0;
+        forever {
+            if (size == m_contents.size()) {
+                if (m_contents.size() > std::numeric_limits<int>::max() / 2) {
+                    setError(EFBIG);
+                    break;
+                }
+                m_contents.resize(m_contents.size() * 2);
+            }
+
+            const ssize_t result = readFile(fd, m_contents.data() + size, m_contents.size() - size, -1);
+            if (result == -1) {
+                setError(errno);
+                break;
+            }
+            if (!result)
+                break;
+            size += result;
+        }
+
+        ::close(fd);
+        m_contents.resize(size);
+
+        // hex and base64 expand the contents past what a QString can hold
+        if (!errorNo() && m_encoding != BufferEncoding::Invalid
+                && BufferObject::decodedLength(size_t(size), m_encoding) > BufferObject::MaxStringLength) {
+            m_contents.clear();
+            setError(EFBIG);
+        }
+    }
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope);
+        // Without an encoding the Buffer adopts the QByteArray's storage
+        if (m_encoding == BufferEncoding::Invalid)
+            v = v4->memoryManager->alloc<BufferObject>(v4, &m_contents);
+        else
+            v = v4->newString(BufferObject::decode(m_contents.constData(), m_contents.size(), m_encoding));
+        arguments->push_back(v);
+    }
+
+private:
+    QByteArray m_file;
+    int m_flags;
+    BufferEncoding m_encoding;
+    QByteArray m_contents;
+};
+
+class WriteFileWork : public AsyncWork
+{
+public:
+    WriteFileWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path, int flags,
+                  mode_t mode, const WriteData &data) :
+        AsyncWork(v4, *callback, QStringLiteral("open"), path),
+        m_file(QFile::encodeName(path)),
+        m_flags(flags),
+        m_mode(mode),
+        m_data(data)
+    {
+
+    }
+
+    void execute() override
+    {
+        const int fd = openFile(m_file, m_flags, m_mode);
+        if (fd == -1) {
+            setError(errno);
+            return;
+        }
+
+        if (writeFile(fd, m_data.data(), m_data.length(), -1) == -1)
+            setError(errno);
+        if (::close(fd) == -1 && !errorNo() && errno != EINTR)
+            setError(errno);
+    }
+
+private:
+    QByteArray m_file;
+    int m_flags;
+    mode_t m_mode;
+    WriteData m_data;
+};
+
+class CopyFileWork : public AsyncWork
+{
+public:
+    CopyFileWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &source,
+                 const QString &destination, int flags) :
+        AsyncWork(v4, callback, QStringLiteral("copyfile"), source),
+        m_source(QFile::encodeName(source)),
+        m_destination(QFile::encodeName(destination)),
+        m_flags(flags)
+    {
+
+    }
+
+    void execute() override
+    {
+        setError(copyFile(m_source, m_destination, m_flags));
+    }
+
+private:
+    QByteArray m_source;
+    QByteArray m_destination;
+    int m_flags;
+};
+
+// Copies between two open descriptors, for piping file streams
+class CopyFdWork : public AsyncWork
+{
+public:
+    CopyFdWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, int inFd, int outFd,
+               qint64 position, qint64 length) :
+        AsyncWork(v4, callback, QStringLiteral("copy_file_range")),
+        m_inFd(inFd),
+        m_outFd(outFd),
+        m_position(position),
+        m_length(length)
+    {
+
+    }
+
+    void execute() override
+    {
+        if (m_position >= 0 && ::lseek(m_inFd, m_position, SEEK_SET) == -1) {
+            setError(errno);
+            return;
+        }
+
+        m_copied = copyFileData(m_inFd, m_outFd, m_length);
+        if (m_copied == -1)
+            setError(errno);
+    }
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope, QV4::Primitive::fromDouble(m_copied));
+        arguments->push_back(v);
+    }
+
+private:
+    int m_inFd;
+    int m_outFd;
+    qint64 m_position;
+    qint64 m_length;
+    qint64 m_copied = 0;
+};
+
+class StatWork : public AsyncWork
+{
+public:
+    StatWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path) :
+        AsyncWork(v4, *callback, QStringLiteral("stat"), path),
+        m_file(QFile::encodeName(path))
+    {
+
+    }
+
+    void execute() override
+    {
+        if (::stat(m_file.constData(), &m_stat) == -1)
+            setError(errno);
+    }
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope, v4->memoryManager->alloc<StatsObject>(v4, m_stat));
+        arguments->push_back(v);
+    }
+
+private:
+    QByteArray m_file;
+    struct stat m_stat;
+};
+
+class ReaddirWork : public AsyncWork
+{
+public:
+    ReaddirWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path) :
+        AsyncWork(v4, *callback, QStringLiteral("scandir"), path),
+        m_file(QFile::encodeName(path))
+    {
+
+    }
+
+    void execute() override
+    {
+        DIR *dir = ::opendir(m_file.constData());
+        if (!dir) {
+            setError(errno);
+            return;
+        }
+
+        errno = 0;
+        while (const struct dirent *entry = ::readdir(dir)) {
+            if (qstrcmp(entry->d_name, ".") && qstrcmp(entry->d_name, ".."))
+                m_entries.append(QFile::decodeName(entry->d_name));
+            errno = 0;
+        }
+        if (errno)
+            setError(errno);
+        ::closedir(dir);
+    }
+
+    void appendResults(QV4::ExecutionEngine *v4, QV4::ArrayObject *arguments) override
+    {
+        QV4::Scope scope(v4);
+        QV4::ScopedValue v(scope, v4->newArrayObject(m_entries));
+        arguments->push_back(v);
+    }
+
+private:
+    QByteArray m_file;
+    QStringList m_entries;
+};
+
+class UnlinkWork : public AsyncWork
+{
+public:
+    UnlinkWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path) :
+        AsyncWork(v4, *callback, QStringLiteral("unlink"), path),
+        m_file(QFile::encodeName(path))
+    {
+
+    }
+
+    void execute() override
+    {
+        if (::unlink(m_file.constData()) == -1)
+            setError(errno);
+    }
+
+private:
+    QByteArray m_file;
+};
+
+class MkdirWork : public AsyncWork
+{
+public:
+    MkdirWork(QV4::ExecutionEngine *v4, const QV4::Value &callback, const QString &path, mode_t mode) :
+        AsyncWork(v4, *callback, QStringLiteral("mkdir"), path),
+        m_file(QFile::encodeName(path)),
+        m_mode(mode)
+    {
+
+    }
+
+    void execute() override
+    {
+        if (::mkdir(m_file.constData(), m_mode) == -1)
+            setError(errno);
+    }
+
+private:
+    QByteArray m_file;
+    mode_t m_mode;
+};
+
+// Node passes the callback last, after any number of optional arguments
+inline const QV4::Value *callbackArgument(const QV4::CallData *callData)
+{
+    if (!callData->argc || !callData->args[callData->argc - 1].asFunctionObject())
+        return nullptr;
+    return &callData->args[callData->argc - 1];
+}
+
+inline QV4::ReturnedValue throwCallbackError(QV4::ExecutionEngine *v4, const QString &method)
+{
+    return v4->throwTypeError(method + QStringLiteral(": callback must be a function"));
+}
+
+// Options are either an encoding name or an object with encoding, flag and mode
+struct FileOptions
+{
+    BufferEncoding encoding;
+    int flags;
+    mode_t mode;
+};
+
+bool parseFileOptions(QV4::ExecutionEngine *v4, const QV4::Value &value, FileOptions *options)
+{
+    QV4::Scope scope(v4);
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue encoding(scope);
+    QV4::ScopedValue flags(scope);
+    QV4::ScopedValue v(scope);
+
+    if (value.isString()) {
+        encoding = value;
+    } else if (value.isObject()) {
+        QV4::ScopedObject o(scope, value);
+        encoding = o->get(s = v4->newString(QStringLiteral("encoding")));
+        flags = o->get(s = v4->newString(QStringLiteral("flag")));
+        v = o->get(s = v4->newString(QStringLiteral("mode")));
+        options->mode = parseMode(*v, options->mode);
+    }
+
+    if (!encoding->isUndefined() && !encoding->isNull()) {
+        options->encoding = BufferObject::parseEncoding(encoding->toQStringNoThrow());
+        if (options->encoding == BufferEncoding::Invalid) {
+            v4->throwTypeError(QStringLiteral("Unknown encoding: ") + encoding->toQStringNoThrow());
+            return false;
+        }
+    }
+
+    options->flags = parseFlags(*flags, options->flags);
+    if (options->flags == -1) {
+        v4->throwTypeError(QStringLiteral("Unknown file open flag: ") + flags->toQStringNoThrow());
+        return false;
+    }
+    return true;
+}
+
+struct MappedRegion
+{
+    void *address;
+    size_t length;
+};
+
+// Buffer cleanup for mmapSync(), run once the Buffer and all its slices are gone
+void unmapRegion(void *data, void *cleanupInfo)
+{
+    Q_UNUSED(data)
+    MappedRegion *region = static_cast<MappedRegion *>(cleanupInfo);
+    ::munmap(region->address, region->length);
+    delete region;
+}
+
+int parseMemoryAdvice(const QString &name)
+{
+    if (name == QLatin1String("normal"))
+        return MADV_NORMAL;
+    if (name == QLatin1String("random"))
+        return MADV_RANDOM;
+    if (name == QLatin1String("sequential"))
+        return MADV_SEQUENTIAL;
+    if (name == QLatin1String("willneed"))
+        return MADV_WILLNEED;
+    if (name == QLatin1String("dontneed"))
+        return MADV_DONTNEED;
+    return -1;
+}
+
+// Forwards a call to the stream implementation, which is loaded on first use
+QV4::ReturnedValue callStreamsModule(QV4::CallContext *ctx, const QString &name)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    QV4::Scope scope(v4);
+    QV4::ScopedString s(scope);
+    QV4::ScopedObject streams(scope, ModuleObject::require(ctx, QStringLiteral("_fs_streams")));
+    if (!streams)
+        return QV4::Encode::undefined();
+
+    QV4::ScopedFunctionObject function(scope, streams->get(s = v4->newString(name)));
+    if (!function)
+        return v4->throwTypeError(name + QStringLiteral(": not available"));
+
+    QV4::ScopedCallData cd(scope, callData->argc);
+    cd->thisObject = streams;
+    for (int i = 0; i < callData->argc; ++i)
+        cd->args[i] = callData->args[i];
+    return function->call(cd);
+}
+
+// Hands the work to the pool; the engine stays alive until its callback has run
+inline QV4::ReturnedValue queueWork(QV4::ExecutionEngine *v4, AsyncWork *work)
+{
+    EnginePrivate::get(v4)->queueWork(work);
+    return QV4::Encode::undefined();
+}
+
+}
+
 Heap::FileSystemModule::FileSystemModule(QV4::ExecutionEngine *v4) :
     QV4::Heap::Object(v4)
 {
@@ -20,6 +892,30 @@ Heap::FileSystemModule::FileSystemModule(QV4::ExecutionEngine *v4) :
     self->defineDefaultProperty(QStringLiteral("existsSync"), NodeQml::FileSystemModule::method_existsSync);
     self->defineDefaultProperty(QStringLiteral("renameSync"), NodeQml::FileSystemModule::method_renameSync);
     self->defineDefaultProperty(QStringLiteral("truncateSync"), NodeQml::FileSystemModule::method_truncateSync);
+    self->defineDefaultProperty(QStringLiteral("mmapSync"), NodeQml::FileSystemModule::method_mmapSync, 4);
+    self->defineDefaultProperty(QStringLiteral("copyFileSync"), NodeQml::FileSystemModule::method_copyFileSync, 3);
+
+    self->defineDefaultProperty(QStringLiteral("open"), NodeQml::FileSystemModule::method_open, 4);
+    self->defineDefaultProperty(QStringLiteral("close"), NodeQml::FileSystemModule::method_close, 2);
+    self->defineDefaultProperty(QStringLiteral("read"), NodeQml::FileSystemModule::method_read, 6);
+    self->defineDefaultProperty(QStringLiteral("write"), NodeQml::FileSystemModule::method_write, 6);
+    self->defineDefaultProperty(QStringLiteral("readFile"), NodeQml::FileSystemModule::method_readFile, 3);
+    self->defineDefaultProperty(QStringLiteral("writeFile"), NodeQml::FileSystemModule::method_writeFile, 4);
+    self->defineDefaultProperty(QStringLiteral("stat"), NodeQml::FileSystemModule::method_stat, 2);
+    self->defineDefaultProperty(QStringLiteral("readdir"), NodeQml::FileSystemModule::method_readdir, 2);
+    self->defineDefaultProperty(QStringLiteral("unlink"), NodeQml::FileSystemModule::method_unlink, 2);
+    self->defineDefaultProperty(QStringLiteral("mkdir"), NodeQml::FileSystemModule::method_mkdir, 3);
+    self->defineDefaultProperty(QStringLiteral("copyFile"), NodeQml::FileSystemModule::method_copyFile, 4);
+    self->defineDefaultProperty(QStringLiteral("_copyFd"), NodeQml::FileSystemModule::method_copyFd, 5);
+
+    QV4::ScopedValue v(scope);
+    self->defineReadonlyProperty(QStringLiteral("COPYFILE_EXCL"), (v = QV4::Primitive::fromInt32(CopyFileExcl)));
+    self->defineReadonlyProperty(QStringLiteral("COPYFILE_FICLONE"), (v = QV4::Primitive::fromInt32(CopyFileClone)));
+    self->defineReadonlyProperty(QStringLiteral("COPYFILE_FICLONE_FORCE"), (v = QV4::Primitive::fromInt32(CopyFileCloneForce)));
+
+    self->defineDefaultProperty(QStringLiteral("createReadStream"), NodeQml::FileSystemModule::method_createReadStream, 2);
+    self->defineDefaultProperty(QStringLiteral("createWriteStream"), NodeQml::FileSystemModule::method_createWriteStream, 2);
+    self->defineDefaultProperty(QStringLiteral("_fadvise"), NodeQml::FileSystemModule::method_fadvise, 4);
 }
 
 QV4::ReturnedValue FileSystemModule::method_existsSync(QV4::CallContext *ctx)
@@ -62,3 +958,379 @@ QV4::ReturnedValue FileSystemModule::method_truncateSync(QV4::CallContext *ctx)
 
     return QV4::Encode::undefined();
 }
+
+// mmapSync(path, [offset], [length], [advice])
+// The mapping is private: the Buffer reads straight from the page cache, and
+// writes to it copy the touched pages instead of reaching the file.
+QV4::ReturnedValue FileSystemModule::method_mmapSync(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    if (!callData->argc || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("mmapSync: path must be a string"));
+
+    int advice = MADV_NORMAL;
+    if (callData->argc > 3 && !callData->args[3].isUndefined()) {
+        advice = parseMemoryAdvice(callData->args[3].toQStringNoThrow());
+        if (advice == -1)
+            return v4->throwTypeError(QStringLiteral("mmapSync: unknown advice ") + callData->args[3].toQStringNoThrow());
+    }
+
+    EnginePrivate *node = EnginePrivate::get(v4);
+    const QString path = callData->args[0].toQStringNoThrow();
+    const int fd = openFile(QFile::encodeName(path), O_RDONLY, 0);
+    if (fd == -1)
+        return node->throwErrnoException(errno, QStringLiteral("open"), path);
+
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+        const int error = errno;
+        ::close(fd);
+        return node->throwErrnoException(error, QStringLiteral("fstat"), path);
+    }
+
+    const double size = st.st_size;
+    const double offset = callData->argc > 1 && !callData->args[1].isUndefined() ? callData->args[1].toInteger() : 0;
+    if (offset < 0 || offset > size) {
+        ::close(fd);
+        return v4->throwRangeError(QStringLiteral("Offset is out of bounds"));
+    }
+    const double length = callData->argc > 2 && !callData->args[2].isUndefined()
+            ? callData->args[2].toInteger() : size - offset;
+    // Pages past the end of the file would fault with SIGBUS on access
+    if (length < 0 || offset + length > size) {
+        ::close(fd);
+        return v4->throwRangeError(QStringLiteral("Length extends beyond the end of the file"));
+    }
+
+    if (!length) {
+        ::close(fd);
+        return node->newBuffer(nullptr, 0, nullptr, nullptr);
+    }
+
+    // mmap() wants a page aligned offset
+    static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+    const off_t mapOffset = off_t(offset) & ~off_t(pageSize - 1);
+    const size_t delta = size_t(offset) - mapOffset;
+    const size_t mapLength = size_t(length) + delta;
+
+    void *address = ::mmap(nullptr, mapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, mapOffset);
+    const int error = errno;
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return node->throwErrnoException(error, QStringLiteral("mmap"), path);
+
+    if (advice != MADV_NORMAL)
+        ::madvise(address, mapLength, advice);
+
+    MappedRegion *region = new MappedRegion { address, mapLength };
+    return node->newBuffer(static_cast<char *>(address) + delta, size_t(length), unmapRegion, region);
+}
+
+// copyFileSync(source, destination, [flags])
+QV4::ReturnedValue FileSystemModule::method_copyFileSync(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    if (callData->argc < 2 || !callData->args[0].isString() || !callData->args[1].isString())
+        return v4->throwTypeError(QStringLiteral("copyFileSync: source and destination must be strings"));
+
+    const QString source = callData->args[0].toQStringNoThrow();
+    const int flags = callData->argc > 2 ? callData->args[2].toInt32() : 0;
+    const int error = copyFile(QFile::encodeName(source), QFile::encodeName(callData->args[1].toQStringNoThrow()), flags);
+    if (error)
+        return EnginePrivate::get(v4)->throwErrnoException(error, QStringLiteral("copyfile"), source);
+
+    return QV4::Encode::undefined();
+}
+
+// open(path, [flags], [mode], callback)
+QV4::ReturnedValue FileSystemModule::method_open(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("open"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("open: path must be a string"));
+
+    const int flags = callData->argc > 2 ? parseFlags(callData->args[1], O_RDONLY) : O_RDONLY;
+    if (flags == -1)
+        return v4->throwTypeError(QStringLiteral("Unknown file open flag: ") + callData->args[1].toQStringNoThrow());
+    const mode_t mode = callData->argc > 3 ? parseMode(callData->args[2], 0666) : 0666;
+
+    return queueWork(v4, new OpenWork(v4, *callback, callData->args[0].toQStringNoThrow(), flags, mode));
+}
+
+// close(fd, callback)
+QV4::ReturnedValue FileSystemModule::method_close(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("close"));
+    if (callData->argc < 2 || !callData->args[0].isNumber())
+        return v4->throwTypeError(QStringLiteral("close: fd must be a file descriptor"));
+
+    return queueWork(v4, new CloseWork(v4, *callback, callData->args[0].toInt32()));
+}
+
+// read(fd, buffer, offset, length, position, callback)
+QV4::ReturnedValue FileSystemModule::method_read(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("read"));
+    if (callData->argc < 6)
+        return v4->throwTypeError(QStringLiteral("read: fd, buffer, offset, length and position are required"));
+    if (!callData->args[0].isNumber())
+        return v4->throwTypeError(QStringLiteral("read: fd must be a file descriptor"));
+
+    const BufferObject *buffer = callData->args[1].as<BufferObject>();
+    if (!buffer)
+        return v4->throwTypeError(QStringLiteral("read: second argument needs to be a buffer"));
+
+    const size_t size = buffer->d()->data.size();
+    const double offset = callData->args[2].toInteger();
+    if (offset < 0 || offset > size)
+        return v4->throwRangeError(QStringLiteral("Offset is out of bounds"));
+    const double length = callData->args[3].toInteger();
+    if (length < 0 || offset + length > size)
+        return v4->throwRangeError(QStringLiteral("Length extends beyond buffer"));
+
+    return queueWork(v4, new ReadWork(v4, *callback, callData->args[0].toInt32(), callData->args[1],
+                                      offset, length, parsePosition(callData->args[4])));
+}
+
+// write(fd, buffer, [offset], [length], [position], callback)
+// write(fd, string, [position], [encoding], callback)
+QV4::ReturnedValue FileSystemModule::method_write(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("write"));
+    if (callData->argc < 3 || !callData->args[0].isNumber())
+        return v4->throwTypeError(QStringLiteral("write: fd must be a file descriptor"));
+
+    const int fd = callData->args[0].toInt32();
+    const int argc = callData->argc - 1;
+
+    if (const BufferObject *buffer = callData->args[1].as<BufferObject>()) {
+        const size_t size = buffer->d()->data.size();
+        const double offset = argc > 2 ? callData->args[2].toInteger() : 0;
+        if (offset < 0 || offset > size)
+            return v4->throwRangeError(QStringLiteral("Offset is out of bounds"));
+        const double length = argc > 3 && !callData->args[3].isUndefined()
+                ? callData->args[3].toInteger() : size - offset;
+        if (length < 0 || offset + length > size)
+            return v4->throwRangeError(QStringLiteral("Length extends beyond buffer"));
+
+        const WriteData data(buffer->d()->data, offset, length);
+        return queueWork(v4, new WriteWork(v4, *callback, fd, callData->args[1], data,
+                                           argc > 4 ? parsePosition(callData->args[4]) : -1));
+    }
+
+    BufferEncoding encoding = BufferEncoding::Utf8;
+    if (argc > 3 && !callData->args[3].isUndefined()) {
+        encoding = BufferObject::parseEncoding(callData->args[3].toQStringNoThrow());
+        if (encoding == BufferEncoding::Invalid)
+            return v4->throwTypeError(QStringLiteral("Unknown encoding: ") + callData->args[3].toQStringNoThrow());
+    }
+
+    const WriteData data(callData->args[1], encoding);
+    return queueWork(v4, new WriteWork(v4, *callback, fd, callData->args[1], data,
+                                       argc > 2 ? parsePosition(callData->args[2]) : -1));
+}
+
+// readFile(path, [options], callback)
+QV4::ReturnedValue FileSystemModule::method_readFile(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("readFile"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("readFile: path must be a string"));
+
+    FileOptions options = { BufferEncoding::Invalid, O_RDONLY, 0666 };
+    if (callData->argc > 2 && !parseFileOptions(v4, callData->args[1], &options))
+        return QV4::Encode::undefined();
+
+    return queueWork(v4, new ReadFileWork(v4, *callback, callData->args[0].toQStringNoThrow(),
+                                          options.flags, options.encoding));
+}
+
+// writeFile(path, data, [options], callback)
+QV4::ReturnedValue FileSystemModule::method_writeFile(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("writeFile"));
+    if (callData->argc < 3 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("writeFile: path must be a string"));
+
+    FileOptions options = { BufferEncoding::Utf8, O_TRUNC | O_CREAT | O_WRONLY, 0666 };
+    if (callData->argc > 3 && !parseFileOptions(v4, callData->args[2], &options))
+        return QV4::Encode::undefined();
+
+    const WriteData data(callData->args[1], options.encoding);
+    return queueWork(v4, new WriteFileWork(v4, *callback, callData->args[0].toQStringNoThrow(),
+                                           options.flags, options.mode, data));
+}
+
+// stat(path, callback)
+QV4::ReturnedValue FileSystemModule::method_stat(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("stat"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("stat: path must be a string"));
+
+    return queueWork(v4, new StatWork(v4, *callback, callData->args[0].toQStringNoThrow()));
+}
+
+// readdir(path, callback)
+QV4::ReturnedValue FileSystemModule::method_readdir(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("readdir"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("readdir: path must be a string"));
+
+    return queueWork(v4, new ReaddirWork(v4, *callback, callData->args[0].toQStringNoThrow()));
+}
+
+// unlink(path, callback)
+QV4::ReturnedValue FileSystemModule::method_unlink(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("unlink"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("unlink: path must be a string"));
+
+    return queueWork(v4, new UnlinkWork(v4, *callback, callData->args[0].toQStringNoThrow()));
+}
+
+// mkdir(path, [mode], callback)
+QV4::ReturnedValue FileSystemModule::method_mkdir(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("mkdir"));
+    if (callData->argc < 2 || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("mkdir: path must be a string"));
+
+    const mode_t mode = callData->argc > 2 ? parseMode(callData->args[1], 0777) : 0777;
+    return queueWork(v4, new MkdirWork(v4, *callback, callData->args[0].toQStringNoThrow(), mode));
+}
+
+// copyFile(source, destination, [flags], callback)
+QV4::ReturnedValue FileSystemModule::method_copyFile(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("copyFile"));
+    if (callData->argc < 3 || !callData->args[0].isString() || !callData->args[1].isString())
+        return v4->throwTypeError(QStringLiteral("copyFile: source and destination must be strings"));
+
+    const int flags = callData->argc > 3 ? callData->args[2].toInt32() : 0;
+    return queueWork(v4, new CopyFileWork(v4, *callback, callData->args[0].toQStringNoThrow(),
+                                          callData->args[1].toQStringNoThrow(), flags));
+}
+
+// _copyFd(inFd, outFd, position, length, callback): position and length may
+// be null for the current offset and everything up to EOF
+QV4::ReturnedValue FileSystemModule::method_copyFd(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const QV4::Value *callback = callbackArgument(callData);
+    if (!callback)
+        return throwCallbackError(v4, QStringLiteral("_copyFd"));
+    if (callData->argc < 5 || !callData->args[0].isNumber() || !callData->args[1].isNumber())
+        return v4->throwTypeError(QStringLiteral("_copyFd: file descriptors are required"));
+
+    const qint64 length = callData->args[3].isNumber() ? qint64(callData->args[3].toInteger()) : -1;
+    return queueWork(v4, new CopyFdWork(v4, *callback, callData->args[0].toInt32(), callData->args[1].toInt32(),
+                                        parsePosition(callData->args[2]), length));
+}
+
+QV4::ReturnedValue FileSystemModule::method_createReadStream(QV4::CallContext *ctx)
+{
+    return callStreamsModule(ctx, QStringLiteral("createReadStream"));
+}
+
+QV4::ReturnedValue FileSystemModule::method_createWriteStream(QV4::CallContext *ctx)
+{
+    return callStreamsModule(ctx, QStringLiteral("createWriteStream"));
+}
+
+// _fadvise(fd, offset, length, advice): a hint only, so failures are ignored
+QV4::ReturnedValue FileSystemModule::method_fadvise(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    if (callData->argc < 4 || !callData->args[0].isNumber())
+        return v4->throwTypeError(QStringLiteral("_fadvise: fd, offset, length and advice are required"));
+
+#ifdef POSIX_FADV_NORMAL
+    const QString name = callData->args[3].toQStringNoThrow();
+    int advice;
+    if (name == QLatin1String("normal"))
+        advice = POSIX_FADV_NORMAL;
+    else if (name == QLatin1String("sequential"))
+        advice = POSIX_FADV_SEQUENTIAL;
+    else if (name == QLatin1String("random"))
+        advice = POSIX_FADV_RANDOM;
+    else if (name == QLatin1String("willneed"))
+        advice = POSIX_FADV_WILLNEED;
+    else if (name == QLatin1String("dontneed"))
+        advice = POSIX_FADV_DONTNEED;
+    else if (name == QLatin1String("noreuse"))
+        advice = POSIX_FADV_NOREUSE;
+    else
+        return v4->throwTypeError(QStringLiteral("_fadvise: unknown advice ") + name);
+
+    ::posix_fadvise(callData->args[0].toInt32(), off_t(callData->args[1].toInteger()),
+                    off_t(callData->args[2].toInteger()), advice);
+#endif
+
+    return QV4::Encode::undefined();
+}
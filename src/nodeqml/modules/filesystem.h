@@ -22,6 +22,28 @@ struct FileSystemModule : QV4::Object
     static QV4::ReturnedValue method_existsSync(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_renameSync(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_truncateSync(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_mmapSync(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_copyFileSync(QV4::CallContext *ctx);
+
+    // Asynchronous, run on the engine's worker pool
+    static QV4::ReturnedValue method_open(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_close(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_read(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_write(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_readFile(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_writeFile(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_stat(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_readdir(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_unlink(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_mkdir(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_copyFile(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_copyFd(QV4::CallContext *ctx);
+
+    // Implemented in js/_fs_streams.js
+    static QV4::ReturnedValue method_createReadStream(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_createWriteStream(QV4::CallContext *ctx);
+
+    static QV4::ReturnedValue method_fadvise(QV4::CallContext *ctx);
 };
 
 } // namespace NodeQml
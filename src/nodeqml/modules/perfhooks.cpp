@@ -0,0 +1,129 @@
+#include "perfhooks.h"
+
+#include "../engine_p.h"
+#include "../eventloopmonitor.h"
+#include "../types/histogram.h"
+
+#include <QDateTime>
+
+#include <private/qv4context_p.h>
+
+using namespace NodeQml;
+
+namespace {
+
+QV4::ReturnedValue newUtilization(QV4::ExecutionEngine *v4, double idle, double active)
+{
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, v4->newObject());
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    const double total = idle + active;
+
+    o->insertMember((s = v4->newString(QStringLiteral("idle"))).getPointer(), (v = QV4::Primitive::fromDouble(idle)));
+    o->insertMember((s = v4->newString(QStringLiteral("active"))).getPointer(), (v = QV4::Primitive::fromDouble(active)));
+    o->insertMember((s = v4->newString(QStringLiteral("utilization"))).getPointer(),
+                    (v = QV4::Primitive::fromDouble(total > 0 ? active / total : 0)));
+
+    return o->asReturnedValue();
+}
+
+bool readUtilization(QV4::ExecutionEngine *v4, const QV4::Value &value, double *idle, double *active)
+{
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, value);
+    if (!o)
+        return false;
+
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    v = o->get(s = v4->newString(QStringLiteral("idle")));
+    *idle = v->toNumber();
+    v = o->get(s = v4->newString(QStringLiteral("active")));
+    *active = v->toNumber();
+
+    return true;
+}
+
+}
+
+Heap::PerfHooksModule::PerfHooksModule(QV4::ExecutionEngine *v4) :
+    QV4::Heap::Object(v4)
+{
+    QV4::Scope scope(v4);
+    QV4::ScopedObject self(scope, this);
+    QV4::ScopedValue v(scope);
+
+    self->defineDefaultProperty(QStringLiteral("monitorEventLoopDelay"), NodeQml::PerfHooksModule::method_monitorEventLoopDelay, 1);
+
+    QV4::ScopedObject performance(scope, v4->newObject());
+    performance->defineDefaultProperty(QStringLiteral("now"), NodeQml::PerfHooksModule::method_now);
+    performance->defineDefaultProperty(QStringLiteral("eventLoopUtilization"), NodeQml::PerfHooksModule::method_eventLoopUtilization, 2);
+
+    const EventLoopMonitor *monitor = EnginePrivate::get(v4)->loopMonitor();
+    const double timeOrigin = QDateTime::currentMSecsSinceEpoch() - monitor->now() / 1e6;
+    performance->defineReadonlyProperty(QStringLiteral("timeOrigin"), (v = QV4::Primitive::fromDouble(timeOrigin)));
+
+    self->defineDefaultProperty(QStringLiteral("performance"), performance);
+}
+
+// monitorEventLoopDelay([options])
+QV4::ReturnedValue PerfHooksModule::method_monitorEventLoopDelay(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    QV4::Scope scope(v4);
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    int resolution = 10;
+    if (callData->argc && !callData->args[0].isUndefined()) {
+        QV4::ScopedObject options(scope, callData->args[0]);
+        if (!options)
+            return v4->throwTypeError(QStringLiteral("monitorEventLoopDelay: options must be an object"));
+
+        v = options->get(s = v4->newString(QStringLiteral("resolution")));
+        if (!v->isUndefined()) {
+            if (!v->isNumber() || v->toInt32() < 1)
+                return v4->throwRangeError(QStringLiteral("monitorEventLoopDelay: resolution must be >= 1"));
+            resolution = v->toInt32();
+        }
+    }
+
+    QV4::Scoped<HistogramObject> histogram(scope, v4->memoryManager->alloc<HistogramObject>(v4, resolution));
+    return histogram.asReturnedValue();
+}
+
+QV4::ReturnedValue PerfHooksModule::method_now(QV4::CallContext *ctx)
+{
+    return QV4::Encode(EnginePrivate::get(ctx->engine())->loopMonitor()->now() / 1e6);
+}
+
+// eventLoopUtilization([utilization1], [utilization2])
+QV4::ReturnedValue PerfHooksModule::method_eventLoopUtilization(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    double idle1 = 0;
+    double active1 = 0;
+    const bool hasUtil1 = callData->argc > 0 && readUtilization(v4, callData->args[0], &idle1, &active1);
+
+    if (hasUtil1 && callData->argc > 1) {
+        double idle2 = 0;
+        double active2 = 0;
+        if (readUtilization(v4, callData->args[1], &idle2, &active2))
+            return newUtilization(v4, idle1 - idle2, active1 - active2);
+    }
+
+    const EventLoopMonitor *monitor = EnginePrivate::get(v4)->loopMonitor();
+    const double idle = monitor->idleTime() / 1e6;
+    const double active = monitor->activeTime() / 1e6;
+
+    if (hasUtil1)
+        return newUtilization(v4, idle - idle1, active - active1);
+    return newUtilization(v4, idle, active);
+}
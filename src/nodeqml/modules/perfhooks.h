@@ -0,0 +1,31 @@
+#ifndef PERFHOOKS_H
+#define PERFHOOKS_H
+
+#include "../v4integration.h"
+
+#include <private/qv4object_p.h>
+
+namespace NodeQml {
+
+namespace Heap {
+
+struct PerfHooksModule : QV4::Heap::Object {
+    PerfHooksModule(QV4::ExecutionEngine *v4);
+};
+
+} // namespace Heap
+
+struct PerfHooksModule : QV4::Object
+{
+    NODE_V4_OBJECT(PerfHooksModule, Object)
+
+    static QV4::ReturnedValue method_monitorEventLoopDelay(QV4::CallContext *ctx);
+
+    // performance
+    static QV4::ReturnedValue method_now(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_eventLoopUtilization(QV4::CallContext *ctx);
+};
+
+} // namespace NodeQml
+
+#endif // PERFHOOKS_H
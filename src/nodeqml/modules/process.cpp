@@ -4,11 +4,51 @@
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
 
 #include <private/qv4context_p.h>
+#include <private/qv4mm_p.h>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
 
 using namespace NodeQml;
 
+namespace {
+
+// Current resident set size on Linux. Other Unix systems only report the peak
+// through getrusage(), which is used as an approximation; elsewhere it is 0.
+double residentSetSize()
+{
+#if defined(Q_OS_LINUX)
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+
+    // size resident shared ... in pages
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+        return 0;
+    return fields.at(1).toDouble() * sysconf(_SC_PAGESIZE);
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef Q_OS_DARWIN
+    return double(usage.ru_maxrss); // bytes
+#else
+    return double(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+    return 0;
+#endif
+}
+
+}
+
 Heap::ProcessModule::ProcessModule(QV4::ExecutionEngine *v4) :
     QV4::Heap::Object(v4)
 {
@@ -26,11 +66,13 @@ Heap::ProcessModule::ProcessModule(QV4::ExecutionEngine *v4) :
                               (v = v4->newString(QStringLiteral("v0.10.33"))));
 
     self->defineAccessorProperty(QStringLiteral("pid"), NodeQml::ProcessModule::property_pid_getter, nullptr);
+    self->defineAccessorProperty(QStringLiteral("_tickInfo"), NodeQml::ProcessModule::property_tickInfo_getter, nullptr);
 
     self->defineDefaultProperty(QStringLiteral("abort"), NodeQml::ProcessModule::method_abort);
     self->defineDefaultProperty(QStringLiteral("chdir"), NodeQml::ProcessModule::method_chdir);
     self->defineDefaultProperty(QStringLiteral("cwd"), NodeQml::ProcessModule::method_cwd);
     self->defineDefaultProperty(QStringLiteral("exit"), NodeQml::ProcessModule::method_exit);
+    self->defineDefaultProperty(QStringLiteral("memoryUsage"), NodeQml::ProcessModule::method_memoryUsage);
     self->defineDefaultProperty(QStringLiteral("nextTick"), NodeQml::ProcessModule::method_nextTick);
 }
 
@@ -41,6 +83,25 @@ QV4::ReturnedValue ProcessModule::property_pid_getter(QV4::CallContext *ctx)
     return QV4::Primitive::fromInt32(QCoreApplication::applicationPid()).asReturnedValue();
 }
 
+// Batching statistics of the nextTick queue
+QV4::ReturnedValue ProcessModule::property_tickInfo_getter(QV4::CallContext *ctx)
+{
+    QV4::ExecutionEngine *v4 = ctx->engine();
+    const EnginePrivate::TickStatistics stats = EnginePrivate::get(v4)->tickStatistics();
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject info(scope, v4->newObject());
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    info->insertMember((s = v4->newString(QStringLiteral("drains"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.drains)));
+    info->insertMember((s = v4->newString(QStringLiteral("ticks"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.ticks)));
+    info->insertMember((s = v4->newString(QStringLiteral("lastDrain"))).getPointer(), (v = QV4::Primitive::fromUInt32(stats.lastDrain)));
+    info->insertMember((s = v4->newString(QStringLiteral("maxDrain"))).getPointer(), (v = QV4::Primitive::fromUInt32(stats.maxDrain)));
+
+    return info->asReturnedValue();
+}
+
 QV4::ReturnedValue ProcessModule::method_abort(QV4::CallContext *ctx)
 {
     Q_UNUSED(ctx);
@@ -79,6 +140,29 @@ QV4::ReturnedValue ProcessModule::method_exit(QV4::CallContext *ctx)
     return QV4::Encode::undefined();
 }
 
+// external is the buffer payload held outside of the V4 heap
+QV4::ReturnedValue ProcessModule::method_memoryUsage(QV4::CallContext *ctx)
+{
+    QV4::ExecutionEngine *v4 = ctx->engine();
+    const QV4::MemoryManager *mm = v4->memoryManager;
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject usage(scope, v4->newObject());
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    const double heapTotal = mm->getAllocatedMem() + mm->getLargeItemsMem();
+    const double heapUsed = mm->getUsedMem() + mm->getLargeItemsMem();
+    const double external = EnginePrivate::get(v4)->externalMemory();
+
+    usage->insertMember((s = v4->newString(QStringLiteral("rss"))).getPointer(), (v = QV4::Primitive::fromDouble(residentSetSize())));
+    usage->insertMember((s = v4->newString(QStringLiteral("heapTotal"))).getPointer(), (v = QV4::Primitive::fromDouble(heapTotal)));
+    usage->insertMember((s = v4->newString(QStringLiteral("heapUsed"))).getPointer(), (v = QV4::Primitive::fromDouble(heapUsed)));
+    usage->insertMember((s = v4->newString(QStringLiteral("external"))).getPointer(), (v = QV4::Primitive::fromDouble(external)));
+
+    return usage->asReturnedValue();
+}
+
 QV4::ReturnedValue ProcessModule::method_nextTick(QV4::CallContext *ctx)
 {
     return EnginePrivate::get(ctx->engine())->nextTick(ctx);
@@ -20,6 +20,7 @@ struct ProcessModule : QV4::Object
     NODE_V4_OBJECT(ProcessModule, Object)
 
     static QV4::ReturnedValue property_pid_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_tickInfo_getter(QV4::CallContext *ctx);
 
     /// TODO: Event: 'exit'
     /// TODO: Event: 'uncaughtException'
@@ -44,7 +45,7 @@ struct ProcessModule : QV4::Object
     /// TODO: process.config
     /// TODO: process.kill(pid, [signal])
     /// TODO: process.title
-    /// TODO: process.memoryUsage()
+    static QV4::ReturnedValue method_memoryUsage(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_nextTick(QV4::CallContext *ctx);
     /// TODO: process.maxTickDepth
     /// TODO: process.umask([mask])
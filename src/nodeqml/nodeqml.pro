@@ -7,7 +7,9 @@ TEMPLATE = lib
 DEFINES += NODEQML_LIBRARY
 
 SOURCES += \
+    asyncwork.cpp \
     engine.cpp \
+    eventloopmonitor.cpp \
     globalextensions.cpp \
     moduleobject.cpp \
     modules/console.cpp \
@@ -15,17 +17,31 @@ SOURCES += \
     modules/filesystem.cpp \
     modules/os.cpp \
     modules/path.cpp \
+    modules/perfhooks.cpp \
     modules/process.cpp \
     modules/util.cpp \
     types/buffer.cpp \
-    types/errnoexception.cpp
+    types/errnoexception.cpp \
+    types/histogram.cpp \
+    types/immediate.cpp \
+    types/stats.cpp \
+    types/timeout.cpp \
+    util/bufferpool.cpp \
+    util/bytesearch.cpp \
+    util/codecs.cpp \
+    util/hdrhistogram.cpp \
+    util/packageindex.cpp \
+    util/timerwheel.cpp \
+    util/valuequeue.cpp
 
 HEADERS_PUBLIC += \
     nodeqml_global.h \
     engine.h
 
 HEADERS_PRIVATE += \
+    asyncwork.h \
     engine_p.h \
+    eventloopmonitor.h \
     globalextensions.h \
     v4integration.h \
     moduleobject.h \
@@ -34,11 +50,31 @@ HEADERS_PRIVATE += \
     modules/filesystem.h \
     modules/os.h \
     modules/path.h \
+    modules/perfhooks.h \
     modules/process.h \
     modules/util.h \
     types/buffer.h \
     types/errnoexception.h \
-    util/qarraydataslice.h
+    types/histogram.h \
+    types/immediate.h \
+    types/stats.h \
+    types/timeout.h \
+    util/bufferpool.h \
+    util/bytesearch.h \
+    util/codecs.h \
+    util/hdrhistogram.h \
+    util/packageindex.h \
+    util/qarraydataslice.h \
+    util/timerwheel.h \
+    util/valuequeue.h
+
+# qmake CONFIG+=nodeqml_io_uring: file I/O through io_uring (Linux 5.6+, liburing)
+nodeqml_io_uring {
+    DEFINES += NODEQML_IO_URING
+    SOURCES += iouring.cpp
+    HEADERS_PRIVATE += iouring.h
+    LIBS += -luring
+}
 
 HEADERS += $$HEADERS_PUBLIC $$HEADERS_PRIVATE
 
@@ -1,15 +1,205 @@
 #include "buffer.h"
 
 #include "../engine_p.h"
+#include "../util/bytesearch.h"
+#include "../util/codecs.h"
 
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtEndian>
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 #include <private/qv4engine_p.h>
 #include <private/qv4jsonobject_p.h>
 
 using namespace NodeQml;
 
+namespace {
+
+template <typename T, bool BigEndian>
+struct Endian
+{
+    static T load(const uchar *src) { return BigEndian ? qFromBigEndian<T>(src) : qFromLittleEndian<T>(src); }
+    static void store(T value, uchar *dst) { BigEndian ? qToBigEndian<T>(value, dst) : qToLittleEndian<T>(value, dst); }
+};
+
+template <typename T, typename Bits, bool BigEndian>
+struct FloatEndian
+{
+    static T load(const uchar *src)
+    {
+        const Bits bits = Endian<Bits, BigEndian>::load(src);
+        T value;
+        memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    static void store(T value, uchar *dst)
+    {
+        Bits bits;
+        memcpy(&bits, &value, sizeof(T));
+        Endian<Bits, BigEndian>::store(bits, dst);
+    }
+};
+
+template <bool BigEndian>
+struct Endian<float, BigEndian> : FloatEndian<float, quint32, BigEndian> {};
+
+template <bool BigEndian>
+struct Endian<double, BigEndian> : FloatEndian<double, quint64, BigEndian> {};
+
+// Wraps like ToUint32, extended to 64 bits
+inline quint64 toUInt64(double value)
+{
+    const double twoTo64 = 18446744073709551616.0;
+    if (!std::isfinite(value))
+        return 0;
+
+    // Negative values wrap through unsigned negation; adding 2^64 as a double would round
+    const quint64 magnitude = quint64(std::fmod(std::trunc(qAbs(value)), twoTo64));
+    return value < 0 ? 0 - magnitude : magnitude;
+}
+
+template <typename T, bool Integral = std::is_integral<T>::value, bool Wide = (sizeof(T) == 8)>
+struct NumberConversion;
+
+template <typename T>
+struct NumberConversion<T, true, false>
+{
+    static T fromNumber(double value) { return T(QV4::Primitive::toInt32(value)); }
+    static bool inRange(double value)
+    {
+        return value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max();
+    }
+};
+
+// 64-bit integers travel as doubles, so values above 2^53 lose precision
+template <typename T>
+struct NumberConversion<T, true, true>
+{
+    static T fromNumber(double value) { return T(toUInt64(value)); }
+    static bool inRange(double value)
+    {
+        // max() rounds up to a power of two as a double
+        return value >= double(std::numeric_limits<T>::min()) && value < double(std::numeric_limits<T>::max());
+    }
+};
+
+template <typename T>
+struct NumberConversion<T, false, false>
+{
+    static T fromNumber(double value) { return T(value); }
+    static bool inRange(double value) { return !std::isfinite(value) || qAbs(value) <= FLT_MAX; }
+};
+
+template <typename T>
+struct NumberConversion<T, false, true>
+{
+    static T fromNumber(double value) { return value; }
+    static bool inRange(double) { return true; }
+};
+
+// Largest integer a double represents exactly
+const double MaxLength = 9007199254740991.0;
+
+// Buffers may exceed 2 GB, their lengths then become doubles
+inline QV4::Primitive fromSize(size_t size)
+{
+    return size <= size_t(std::numeric_limits<int>::max())
+            ? QV4::Primitive::fromInt32(int(size)) : QV4::Primitive::fromDouble(double(size));
+}
+
+inline QV4::ReturnedValue encodeNumber(int value) { return QV4::Encode(value); }
+inline QV4::ReturnedValue encodeNumber(uint value) { return QV4::Encode(value); }
+inline QV4::ReturnedValue encodeNumber(qint64 value) { return QV4::Encode(double(value)); }
+inline QV4::ReturnedValue encodeNumber(quint64 value) { return QV4::Encode(double(value)); }
+inline QV4::ReturnedValue encodeNumber(double value) { return QV4::Encode(value); }
+
+int compareSlices(const QTypedArrayDataSlice<char> &a, const QTypedArrayDataSlice<char> &b)
+{
+    const size_t length = qMin(a.size(), b.size());
+    const int result = length ? memcmp(a.constData(), b.constData(), length) : 0;
+    if (result)
+        return result < 0 ? -1 : 1;
+    return a.size() < b.size() ? -1 : a.size() > b.size();
+}
+
+// Shared by indexOf() and includes(), returns -1 when there is no match
+QV4::ReturnedValue searchBuffer(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const BufferObject *self = callData->thisObject.as<BufferObject>();
+    if (!self || !callData->argc)
+        return v4->throwTypeError();
+
+    // (value, [byteOffset], [encoding]) or (value, encoding)
+    double offset = 0;
+    BufferEncoding encoding = BufferEncoding::Utf8;
+    int encodingIndex = 2;
+    if (callData->argc > 1) {
+        if (callData->args[1].isString())
+            encodingIndex = 1;
+        else
+            offset = callData->args[1].toNumber();
+    }
+    if (callData->argc > encodingIndex && !callData->args[encodingIndex].isUndefined()) {
+        const QString encodingStr = callData->args[encodingIndex].toQStringNoThrow();
+        encoding = BufferObject::parseEncoding(encodingStr);
+        if (encoding == BufferEncoding::Invalid)
+            return v4->throwTypeError(QString("Unknown encoding: %1").arg(encodingStr));
+    }
+    if (v4->hasException)
+        return QV4::Encode::undefined();
+
+    const uchar *haystack = reinterpret_cast<const uchar *>(self->d()->data.constData());
+    const size_t length = self->d()->data.size();
+
+    // Negative offsets count from the end, like Array.prototype.indexOf
+    if (std::isnan(offset))
+        offset = 0;
+    else if (offset < 0)
+        offset = qMax<double>(0, length + offset);
+    const size_t start = qMin<double>(offset, length);
+
+    const QV4::Value &value = callData->args[0];
+    uchar byte;
+    const uchar *needle;
+    size_t needleLength;
+    QVarLengthArray<char, 256> encoded;
+
+    if (const BufferObject *buffer = value.as<BufferObject>()) {
+        needle = reinterpret_cast<const uchar *>(buffer->d()->data.constData());
+        needleLength = buffer->d()->data.size();
+    } else if (value.isString()) {
+        const QString str = value.toQStringNoThrow();
+        encoded.resize(BufferObject::byteLength(str, encoding));
+        needle = reinterpret_cast<const uchar *>(encoded.constData());
+        needleLength = BufferObject::encode(str, encoding, encoded.data(), encoded.size());
+    } else if (value.isNumber()) {
+        byte = value.toInt32() & 0xff;
+        needle = &byte;
+        needleLength = 1;
+    } else {
+        return v4->throwTypeError(QStringLiteral("indexOf: value must be a string, number or Buffer"));
+    }
+
+    if (!needleLength)
+        return QV4::Encode(double(start));
+
+    const size_t found = ByteSearch::indexOf(haystack + start, length - start, needle, needleLength);
+    return QV4::Encode(found == ByteSearch::NotFound ? -1.0 : double(start + found));
+}
+
+}
+
 DEFINE_OBJECT_VTABLE(BufferObject);
 
 Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, size_t length) :
@@ -17,20 +207,37 @@ Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, size_t length) :
 {
     setVTable(NodeQml::BufferObject::staticVTable());
 
-    if (!allocateData(length)) {
+    if (!allocateData(v4, length)) {
         v4->throwRangeError(QStringLiteral("Buffer: Out of memory"));
         return;
     }
 
     QV4::Scope scope(v4);
     QV4::ScopedObject o(scope, this);
-    o->defineReadonlyProperty(v4->id_length, QV4::Primitive::fromInt32(length));
+    o->defineReadonlyProperty(v4->id_length, fromSize(length));
 }
 
 Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, const QString &str, BufferEncoding encoding) :
     QV4::Heap::Object(EnginePrivate::get(v4)->bufferClass)
 {
     setVTable(NodeQml::BufferObject::staticVTable());
+
+    const size_t capacity = NodeQml::BufferObject::byteLength(str, encoding);
+    if (!allocateData(v4, capacity)) {
+        v4->throwRangeError(QStringLiteral("Buffer: Out of memory"));
+        return;
+    }
+
+    // Invalid hex or base64 input decodes to fewer bytes than estimated
+    const size_t length = NodeQml::BufferObject::encode(str, encoding, data.data(), capacity);
+    if (!length)
+        data.clearData();
+    else if (length < capacity)
+        data = QTypedArrayDataSlice<char>(data, 0, length);
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, this);
+    o->defineReadonlyProperty(v4->id_length, fromSize(length));
 }
 
 Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, QV4::ArrayObject *array) :
@@ -44,7 +251,7 @@ Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, QV4::ArrayObject *arr
 
     const uint length = a->getLength();
 
-    if (!allocateData(length)) {
+    if (!allocateData(v4, length)) {
         v4->throwRangeError(QStringLiteral("Buffer: Out of memory"));
         return;
     }
@@ -55,27 +262,56 @@ Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, QV4::ArrayObject *arr
     }
 
     QV4::ScopedObject o(scope, this);
-    o->defineReadonlyProperty(v4->id_length, QV4::Primitive::fromInt32(length));
+    o->defineReadonlyProperty(v4->id_length, fromSize(length));
 }
 
-Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, const QByteArray &ba) :
+Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, QByteArray *ba) :
     QV4::Heap::Object(EnginePrivate::get(v4)->bufferClass)
 {
     setVTable(NodeQml::BufferObject::staticVTable());
 
-    const size_t length = ba.length();
-
-    if (!allocateData(length)) {
+    const size_t length = ba->length();
+    QByteArray::DataPtr arrayData = ba->data_ptr();
+
+    // Only heap allocated data no other QByteArray refers to is adopted, since
+    // writes to the Buffer must not show through. Literals, raw data and
+    // unsharable arrays may be read-only or short-lived, so those are copied.
+    if (length && arrayData->alloc && arrayData->ref.isSharable() && !arrayData->ref.isShared()) {
+        data.setData(arrayData);
+        *ba = QByteArray();
+        externalSize = length;
+        EnginePrivate::get(v4)->adjustExternalMemory(length);
+    } else if (allocateData(v4, length)) {
+        memcpy(data.data(), ba->constData(), length);
+    } else {
         v4->throwRangeError(QStringLiteral("Buffer: Out of memory"));
         return;
     }
 
-    for (uint i = 0; i < length; ++i)
-        data.data()[i] = ba.at(i) & 0xff;
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, this);
+    o->defineReadonlyProperty(v4->id_length, fromSize(length));
+}
+
+Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, char *external, size_t length,
+                                 QExternalArrayData::CleanupFunction cleanupFunction, void *cleanupInfo) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->bufferClass)
+{
+    setVTable(NodeQml::BufferObject::staticVTable());
+
+    if (length) {
+        QTypedArrayData<char> *arrayData = QExternalArrayData::create(external, length, cleanupFunction, cleanupInfo);
+        data.setData(arrayData);
+        arrayData->ref.deref(); // Disown data
+        externalSize = length;
+        EnginePrivate::get(v4)->adjustExternalMemory(length);
+    } else if (cleanupFunction) {
+        cleanupFunction(external, cleanupInfo);
+    }
 
     QV4::Scope scope(v4);
     QV4::ScopedObject o(scope, this);
-    o->defineReadonlyProperty(v4->id_length, QV4::Primitive::fromInt32(length));
+    o->defineReadonlyProperty(v4->id_length, fromSize(length));
 }
 
 Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, const QTypedArrayDataSlice<char> &slice) :
@@ -86,21 +322,28 @@ Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, const QTypedArrayData
 
     QV4::Scope scope(v4);
     QV4::ScopedObject o(scope, this);
-    o->defineReadonlyProperty(v4->id_length, QV4::Primitive::fromInt32(data.size()));
+    o->defineReadonlyProperty(v4->id_length, fromSize(data.size()));
 }
 
-bool Heap::BufferObject::allocateData(size_t length)
+Heap::BufferObject::BufferObject(QV4::ExecutionEngine *v4, QTypedArrayDataSlice<char> *slice) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->bufferClass),
+    data(std::move(*slice))
 {
-    if (!length)
-        return true;
+    setVTable(NodeQml::BufferObject::staticVTable());
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, this);
+    o->defineReadonlyProperty(v4->id_length, fromSize(data.size()));
+}
 
-    QTypedArrayData<char> *arrayData = QTypedArrayData<char>::allocate(length + 1);
-    if (!arrayData)
+bool Heap::BufferObject::allocateData(QV4::ExecutionEngine *v4, size_t length)
+{
+    EnginePrivate *engine = EnginePrivate::get(v4);
+    if (!engine->bufferPool()->allocate(length, &data))
         return false;
-    arrayData->size = length;
 
-    data.setData(arrayData);
-    arrayData->ref.deref(); // Disown data
+    externalSize = length;
+    engine->adjustExternalMemory(length);
     return true;
 }
 
@@ -110,7 +353,7 @@ QV4::ReturnedValue BufferObject::getIndexed(QV4::Managed *m, quint32 index, bool
     QV4::Scope scope(v4);
     QV4::Scoped<BufferObject> that(scope, static_cast<BufferObject *>(m));
 
-    if (index >= static_cast<quint32>(that->d()->data.size())) {
+    if (index >= that->d()->data.size()) {
         if (hasProperty)
             *hasProperty = false;
         return QV4::Encode::undefined();
@@ -128,7 +371,7 @@ void BufferObject::putIndexed(QV4::Managed *m, uint index, const QV4::ValueRef v
     QV4::Scope scope(v4);
     QV4::Scoped<BufferObject> that(scope, static_cast<BufferObject *>(m));
 
-    if (index >= static_cast<quint32>(that->d()->data.size()))
+    if (index >= that->d()->data.size())
         return;
 
     that->d()->data[index] = value->toInt32();
@@ -144,6 +387,10 @@ bool BufferObject::deleteIndexedProperty(QV4::Managed *m, uint index)
 void BufferObject::destroy(QV4::Managed *m)
 {
     BufferObject *buffer = static_cast<BufferObject *>(m);
+    // The engine is already gone when the heap is torn down
+    EnginePrivate *engine = EnginePrivate::get(m->engine());
+    if (engine && buffer->d()->externalSize)
+        engine->adjustExternalMemory(-qint64(buffer->d()->externalSize));
     buffer->d()->data.clearData();
 }
 
@@ -175,6 +422,120 @@ bool BufferObject::isEncoding(const QString &str)
     return parseEncoding(str) != BufferEncoding::Invalid;
 }
 
+size_t BufferObject::byteLength(const QString &str, BufferEncoding encoding)
+{
+    const ushort *src = reinterpret_cast<const ushort *>(str.constData());
+    const size_t length = str.length();
+
+    switch (encoding) {
+    case BufferEncoding::Ascii:
+    case BufferEncoding::Binary:
+    case BufferEncoding::Raw:
+        return length;
+    case BufferEncoding::Base64:
+        return Codecs::base64DecodedLength(src, length);
+    case BufferEncoding::Hex:
+        return length / 2;
+    case BufferEncoding::Ucs2:
+    case BufferEncoding::Utf16le:
+        return length * 2;
+    case BufferEncoding::Utf8:
+        return Codecs::utf8Length(src, length);
+    case BufferEncoding::Invalid:
+        break;
+    }
+
+    return 0;
+}
+
+size_t BufferObject::encode(const QString &str, BufferEncoding encoding, char *dst, size_t capacity)
+{
+    const ushort *src = reinterpret_cast<const ushort *>(str.constData());
+    const size_t length = str.length();
+    uchar *out = reinterpret_cast<uchar *>(dst);
+
+    switch (encoding) {
+    case BufferEncoding::Ascii:
+    case BufferEncoding::Binary:
+    case BufferEncoding::Raw: {
+        const size_t n = qMin(length, capacity);
+        Codecs::latin1Encode(src, n, out);
+        return n;
+    }
+    case BufferEncoding::Base64:
+        return Codecs::base64Decode(src, length, out, capacity);
+    case BufferEncoding::Hex:
+        return Codecs::hexDecode(src, qMin(length, capacity * 2), out);
+    case BufferEncoding::Ucs2:
+    case BufferEncoding::Utf16le: {
+        const size_t n = qMin(length, capacity / 2);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        memcpy(dst, src, n * 2);
+#else
+        for (size_t i = 0; i < n; ++i)
+            qToLittleEndian<quint16>(src[i], out + i * 2);
+#endif
+        return n * 2;
+    }
+    case BufferEncoding::Utf8:
+        return Codecs::utf8Encode(src, length, out, capacity);
+    case BufferEncoding::Invalid:
+        break;
+    }
+
+    return 0;
+}
+
+size_t BufferObject::decodedLength(size_t length, BufferEncoding encoding)
+{
+    switch (encoding) {
+    case BufferEncoding::Base64:
+        return Codecs::base64EncodedLength(length);
+    case BufferEncoding::Hex:
+        return Codecs::hexEncodedLength(length);
+    case BufferEncoding::Ucs2:
+    case BufferEncoding::Utf16le:
+        return length >> 1;
+    default:
+        // UTF-8 never yields more UTF-16 units than bytes
+        return length;
+    }
+}
+
+QString BufferObject::decode(const char *src, size_t length, BufferEncoding encoding)
+{
+    const QByteArray data = QByteArray::fromRawData(src, int(length));
+    QString str;
+
+    switch (encoding) {
+    case BufferEncoding::Ascii:
+    case BufferEncoding::Binary:
+    case BufferEncoding::Raw:
+        str = QString::fromLatin1(data);
+        break;
+    case BufferEncoding::Base64:
+        str = QString(int(Codecs::base64EncodedLength(length)), Qt::Uninitialized);
+        Codecs::base64Encode(reinterpret_cast<const uchar *>(src), length, reinterpret_cast<ushort *>(str.data()));
+        break;
+    case BufferEncoding::Hex:
+        str = QString(int(Codecs::hexEncodedLength(length)), Qt::Uninitialized);
+        Codecs::hexEncode(reinterpret_cast<const uchar *>(src), length, reinterpret_cast<ushort *>(str.data()));
+        break;
+    case BufferEncoding::Ucs2:
+    case BufferEncoding::Utf16le:
+        str = QString::fromUtf16(reinterpret_cast<const ushort *>(src), length >> 1);
+        break;
+    case BufferEncoding::Utf8:
+        str = QString::fromUtf8(data);
+        break;
+    case BufferEncoding::Invalid:
+        // Should never happen
+        break;
+    }
+
+    return str;
+}
+
 DEFINE_OBJECT_VTABLE(BufferCtor);
 
 Heap::BufferCtor::BufferCtor(QV4::ExecutionContext *scope) :
@@ -187,9 +548,13 @@ QV4::ReturnedValue BufferCtor::construct(QV4::Managed *m, QV4::CallData *callDat
 {
     QV4::ExecutionEngine *v4 = m->engine();
     QV4::Scope scope(v4);
+    EnginePrivate::get(v4)->checkExternalMemoryPressure();
     if (callData->argc) {
-        if (callData->args[0].isInt32()) {
-            QV4::Scoped<BufferObject> object(scope, v4->memoryManager->alloc<BufferObject>(v4, callData->args[0].toInt32()));
+        if (callData->args[0].isNumber()) {
+            const double length = callData->args[0].toNumber();
+            if (!(length >= 0 && length <= MaxLength))
+                return v4->throwRangeError(QStringLiteral("Buffer: Invalid length"));
+            QV4::Scoped<BufferObject> object(scope, v4->memoryManager->alloc<BufferObject>(v4, size_t(length)));
             return object->asReturnedValue();
         } else if (callData->args[0].asArrayObject()) {
             QV4::Scoped<BufferObject> object(scope, v4->memoryManager->alloc<BufferObject>(v4, callData->args[0].asArrayObject()));
@@ -205,7 +570,10 @@ QV4::ReturnedValue BufferCtor::construct(QV4::Managed *m, QV4::CallData *callDat
                     return v4->throwTypeError(QString("Unknown Encoding: %1").arg(encStr));
                 encoding = enc;
             }
-            QV4::Scoped<BufferObject> object(scope, v4->memoryManager->alloc<BufferObject>(v4, callData->args[0].toQStringNoThrow(), encoding));
+            const QString str = callData->args[0].toQStringNoThrow();
+            if (encoding == BufferEncoding::Hex && str.length() % 2)
+                return v4->throwTypeError(QStringLiteral("Invalid hex string"));
+            QV4::Scoped<BufferObject> object(scope, v4->memoryManager->alloc<BufferObject>(v4, str, encoding));
             return object->asReturnedValue();
         }
     }
@@ -230,12 +598,58 @@ void BufferPrototype::init(QV4::ExecutionEngine *v4, QV4::Object *ctor)
     ctor->defineDefaultProperty(QStringLiteral("isEncoding"), method_isEncoding, 1);
     ctor->defineDefaultProperty(QStringLiteral("isBuffer"), method_isBuffer, 1);
     ctor->defineDefaultProperty(QStringLiteral("byteLength"), method_byteLength);
+    ctor->defineDefaultProperty(QStringLiteral("concat"), method_concat, 2);
+    ctor->defineDefaultProperty(QStringLiteral("compare"), method_compare, 2);
+    ctor->defineDefaultProperty(QStringLiteral("_poolStats"), method_poolStats);
 
     defineDefaultProperty(QStringLiteral("copy"), method_copy, 4);
     defineDefaultProperty(QStringLiteral("fill"), method_fill, 3);
     defineDefaultProperty(QStringLiteral("slice"), method_slice, 2);
+    defineDefaultProperty(QStringLiteral("equals"), method_equals, 1);
+    defineDefaultProperty(QStringLiteral("compare"), method_instanceCompare, 1);
+    defineDefaultProperty(QStringLiteral("indexOf"), method_indexOf, 3);
+    defineDefaultProperty(QStringLiteral("includes"), method_includes, 3);
+    defineDefaultProperty(QStringLiteral("write"), method_write, 4);
     defineDefaultProperty(QStringLiteral("toString"), method_toString, 3);
     defineDefaultProperty(QStringLiteral("toJSON"), method_toJSON);
+
+    defineDefaultProperty(QStringLiteral("readUInt8"), method_readNumber<quint8, false>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt16LE"), method_readNumber<quint16, false>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt16BE"), method_readNumber<quint16, true>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt32LE"), method_readNumber<quint32, false>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt32BE"), method_readNumber<quint32, true>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt64LE"), method_readNumber<quint64, false>, 2);
+    defineDefaultProperty(QStringLiteral("readUInt64BE"), method_readNumber<quint64, true>, 2);
+    defineDefaultProperty(QStringLiteral("readInt8"), method_readNumber<qint8, false>, 2);
+    defineDefaultProperty(QStringLiteral("readInt16LE"), method_readNumber<qint16, false>, 2);
+    defineDefaultProperty(QStringLiteral("readInt16BE"), method_readNumber<qint16, true>, 2);
+    defineDefaultProperty(QStringLiteral("readInt32LE"), method_readNumber<qint32, false>, 2);
+    defineDefaultProperty(QStringLiteral("readInt32BE"), method_readNumber<qint32, true>, 2);
+    defineDefaultProperty(QStringLiteral("readInt64LE"), method_readNumber<qint64, false>, 2);
+    defineDefaultProperty(QStringLiteral("readInt64BE"), method_readNumber<qint64, true>, 2);
+    defineDefaultProperty(QStringLiteral("readFloatLE"), method_readNumber<float, false>, 2);
+    defineDefaultProperty(QStringLiteral("readFloatBE"), method_readNumber<float, true>, 2);
+    defineDefaultProperty(QStringLiteral("readDoubleLE"), method_readNumber<double, false>, 2);
+    defineDefaultProperty(QStringLiteral("readDoubleBE"), method_readNumber<double, true>, 2);
+
+    defineDefaultProperty(QStringLiteral("writeUInt8"), method_writeNumber<quint8, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt16LE"), method_writeNumber<quint16, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt16BE"), method_writeNumber<quint16, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt32LE"), method_writeNumber<quint32, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt32BE"), method_writeNumber<quint32, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt64LE"), method_writeNumber<quint64, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeUInt64BE"), method_writeNumber<quint64, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt8"), method_writeNumber<qint8, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt16LE"), method_writeNumber<qint16, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt16BE"), method_writeNumber<qint16, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt32LE"), method_writeNumber<qint32, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt32BE"), method_writeNumber<qint32, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt64LE"), method_writeNumber<qint64, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeInt64BE"), method_writeNumber<qint64, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeFloatLE"), method_writeNumber<float, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeFloatBE"), method_writeNumber<float, true>, 3);
+    defineDefaultProperty(QStringLiteral("writeDoubleLE"), method_writeNumber<double, false>, 3);
+    defineDefaultProperty(QStringLiteral("writeDoubleBE"), method_writeNumber<double, true>, 3);
 }
 
 QV4::ReturnedValue BufferPrototype::method_isEncoding(QV4::CallContext *ctx)
@@ -264,33 +678,164 @@ QV4::ReturnedValue BufferPrototype::method_byteLength(QV4::CallContext *ctx)
         encoding = BufferObject::parseEncoding(callData->args[1].toQStringNoThrow());
     }
 
-    switch (encoding) {
-    case BufferEncoding::Ascii:
-    case BufferEncoding::Binary:
-    case BufferEncoding::Raw:
-        return QV4::Encode(callData->args[0].stringValue()->d()->length());
-    case BufferEncoding::Base64:
-        return QV4::Encode(QByteArray::fromBase64(
-                               callData->args[0].toQStringNoThrow().toUtf8()).length());
-    case BufferEncoding::Hex:
-        return QV4::Encode(callData->args[0].stringValue()->d()->length() >> 1);
-        break;
-    case BufferEncoding::Ucs2:
-    case BufferEncoding::Utf16le:
-        return QV4::Encode(callData->args[0].stringValue()->d()->length() * 2);
-        break;
-    case BufferEncoding::Utf8:
-        return QV4::Encode(callData->args[0].toQStringNoThrow().toUtf8().length());
-    case BufferEncoding::Invalid:
+    const size_t length = BufferObject::byteLength(callData->args[0].toQStringNoThrow(), encoding);
+    return QV4::Encode(double(length));
+}
+
+// concat(list, [totalLength])
+QV4::ReturnedValue BufferPrototype::method_concat(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    if (!callData->argc || !callData->args[0].asArrayObject())
+        return v4->throwTypeError(QStringLiteral("concat: list argument must be an Array of Buffers"));
+
+    QV4::Scope scope(v4);
+    QV4::ScopedArrayObject list(scope, callData->args[0]);
+    QV4::Scoped<BufferObject> buffer(scope);
+
+    const uint count = list->getLength();
+
+    // The list is read once: getters could return something else the second time
+    QVector<QTypedArrayDataSlice<char> > slices;
+    slices.reserve(count);
+    size_t length = 0;
+    for (uint i = 0; i < count; ++i) {
+        buffer = list->getIndexed(i);
+        if (v4->hasException)
+            return QV4::Encode::undefined();
+        if (!buffer)
+            return v4->throwTypeError(QStringLiteral("concat: list argument must be an Array of Buffers"));
+        slices.append(buffer->d()->data);
+        length += slices.last().size();
+    }
+
+    if (callData->argc > 1 && !callData->args[1].isUndefined()) {
+        if (!callData->args[1].isNumber())
+            return v4->throwTypeError(QStringLiteral("concat: totalLength must be a number"));
+        if (callData->args[1].toNumber() < 0)
+            return v4->throwRangeError(QStringLiteral("concat: totalLength must not be negative"));
+        length = size_t(callData->args[1].toInteger());
+    }
+
+    // A single buffer is shared instead of copied
+    if (count == 1 && !slices.first().isNull() && length == slices.first().size()) {
+        QV4::Scoped<BufferObject> result(scope, v4->memoryManager->alloc<BufferObject>(v4, slices.first()));
+        return result.asReturnedValue();
+    }
+
+    EnginePrivate::get(v4)->checkExternalMemoryPressure();
+    QV4::Scoped<BufferObject> result(scope, v4->memoryManager->alloc<BufferObject>(v4, length));
+    if (v4->hasException)
         return QV4::Encode::undefined();
+
+    char *dest = result->d()->data.data();
+    size_t offset = 0;
+    for (int i = 0; i < slices.size() && offset < length; ++i) {
+        const size_t size = qMin<size_t>(slices.at(i).size(), length - offset);
+        if (size)
+            memcpy(dest + offset, slices.at(i).constData(), size);
+        offset += size;
     }
 
-    return QV4::Encode::undefined();
+    // totalLength larger than the sum of the buffers
+    if (offset < length)
+        memset(dest + offset, 0, length - offset);
+
+    return result.asReturnedValue();
 }
 
-QV4::ReturnedValue BufferPrototype::method_concat(QV4::CallContext *ctx)
+// Buffer.compare(buf1, buf2)
+QV4::ReturnedValue BufferPrototype::method_compare(QV4::CallContext *ctx)
 {
-    return ctx->engine()->throwUnimplemented(QStringLiteral("Buffer.concat()"));
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const BufferObject *a = callData->argc > 0 ? callData->args[0].as<BufferObject>() : nullptr;
+    const BufferObject *b = callData->argc > 1 ? callData->args[1].as<BufferObject>() : nullptr;
+    if (!a || !b)
+        return v4->throwTypeError(QStringLiteral("compare: Arguments must be Buffers"));
+
+    return QV4::Encode(compareSlices(a->d()->data, b->d()->data));
+}
+
+// Buffer._poolStats(): counters of the engine's small buffer pool
+QV4::ReturnedValue BufferPrototype::method_poolStats(QV4::CallContext *ctx)
+{
+    NODE_CTX_V4(ctx);
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject o(scope, v4->newObject());
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    const BufferPool::Statistics &stats = EnginePrivate::get(v4)->bufferPool()->statistics();
+    const double hitRate = stats.allocations ? double(stats.pooledAllocations) / stats.allocations : 0;
+
+    o->insertMember((s = v4->newString(QStringLiteral("allocations"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.allocations)));
+    o->insertMember((s = v4->newString(QStringLiteral("pooledAllocations"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.pooledAllocations)));
+    o->insertMember((s = v4->newString(QStringLiteral("hitRate"))).getPointer(), (v = QV4::Primitive::fromDouble(hitRate)));
+    o->insertMember((s = v4->newString(QStringLiteral("pooledBytes"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.pooledBytes)));
+    o->insertMember((s = v4->newString(QStringLiteral("wastedBytes"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.wastedBytes)));
+    o->insertMember((s = v4->newString(QStringLiteral("slabs"))).getPointer(), (v = QV4::Primitive::fromDouble(stats.slabs)));
+    o->insertMember((s = v4->newString(QStringLiteral("slabSize"))).getPointer(), (v = QV4::Primitive::fromDouble(BufferPool::SlabSize)));
+    o->insertMember((s = v4->newString(QStringLiteral("threshold"))).getPointer(), (v = QV4::Primitive::fromDouble(BufferPool::Threshold)));
+
+    return o->asReturnedValue();
+}
+
+// write(string, [offset], [length], [encoding])
+// Also accepts the legacy write(string, encoding, [offset], [length]) order.
+// The string is encoded straight into the buffer memory, no temporary is created
+QV4::ReturnedValue BufferPrototype::method_write(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    BufferObject *self = callData->thisObject.as<BufferObject>();
+    if (!self)
+        return v4->throwTypeError();
+
+    if (!callData->argc || !callData->args[0].isString())
+        return v4->throwTypeError(QStringLiteral("Argument must be a string"));
+
+    BufferEncoding encoding = BufferEncoding::Utf8;
+    double numbers[2] = { 0, 0 };
+    int numberCount = 0;
+    for (int i = 1; i < qMin(callData->argc, 4); ++i) {
+        const QV4::Value &arg = callData->args[i];
+        if (arg.isString()) {
+            const QString encodingStr = arg.toQStringNoThrow();
+            encoding = BufferObject::parseEncoding(encodingStr);
+            if (encoding == BufferEncoding::Invalid)
+                return v4->throwTypeError(QString("Unknown encoding: %1").arg(encodingStr));
+        } else if (!arg.isUndefined() && numberCount < 2) {
+            numbers[numberCount++] = arg.toNumber();
+            if (v4->hasException)
+                return QV4::Encode::undefined();
+        }
+    }
+
+    const size_t size = self->d()->data.size();
+    const double offset = numbers[0];
+    if (!(offset >= 0) || offset != std::floor(offset) || offset > size)
+        return v4->throwRangeError(QStringLiteral("Offset is out of bounds"));
+
+    size_t length = size - size_t(offset);
+    if (numberCount > 1) {
+        const double requested = numbers[1];
+        if (!(requested >= 0))
+            return v4->throwRangeError(QStringLiteral("attempt to write beyond buffer bounds"));
+        length = qMin<double>(requested, length);
+    }
+
+    const QString str = callData->args[0].toQStringNoThrow();
+    if (encoding == BufferEncoding::Hex && str.length() % 2)
+        return v4->throwTypeError(QStringLiteral("Invalid hex string"));
+
+    const size_t written = BufferObject::encode(str, encoding, self->d()->data.data() + size_t(offset), length);
+    return QV4::Encode(double(written));
 }
 
 // toString([encoding], [start], [end])
@@ -308,46 +853,31 @@ QV4::ReturnedValue BufferPrototype::method_toString(QV4::CallContext *ctx)
             return v4->throwTypeError(QString("Unknown encoding: %1").arg(encodingStr));
     }
 
-    const int dataSize = self->d()->data.size();
-    int start = callData->argc > 1
-            ? qMin(callData->args[1].toInt32(), dataSize) : 0;
-    int end = callData->argc > 2 && !callData->args[2].isUndefined()
-            ? qMin(callData->args[2].toInt32(), dataSize) : dataSize - 1;
+    // Clamped as doubles, since converting Infinity or huge values to qint64 is undefined
+    const qint64 dataSize = self->d()->data.size();
+    qint64 start = 0;
+    if (callData->argc > 1)
+        start = qint64(qBound(0.0, callData->args[1].toInteger(), double(dataSize)));
+
+    // end is inclusive
+    qint64 end = dataSize - 1;
+    if (callData->argc > 2 && !callData->args[2].isUndefined()) {
+        const double endArg = callData->args[2].toInteger();
+        if (endArg >= 0)
+            end = qint64(qMin(endArg, double(dataSize - 1)));
+    }
 
-    if (start < 0)
-        start = 0;
-    if (end < 0)
-        end = dataSize - 1;
+    if (end < start)
+        return v4->newString(QString())->asReturnedValue();
 
     const char *startPtr = self->d()->data.data() + start;
-    const int size = end - start + 1;
+    const size_t size = size_t(end - start + 1);
+    // hex and base64 expand the data, and QString is limited to about 2^30 characters
+    if (size > BufferObject::MaxStringLength
+            || BufferObject::decodedLength(size, encoding) > BufferObject::MaxStringLength)
+        return v4->throwRangeError(QStringLiteral("toString: Range too large for a string"));
 
-    const QByteArray data = QByteArray::fromRawData(startPtr, size);
-    QString str;
-
-    switch (encoding) {
-    case BufferEncoding::Ascii:
-    case BufferEncoding::Binary:
-    case BufferEncoding::Raw:
-        str = QString::fromLatin1(data);
-        break;
-    case BufferEncoding::Base64:
-        str = QByteArray::fromBase64(data);
-        break;
-    case BufferEncoding::Hex:
-        str = QByteArray::fromHex(data);
-        break;
-    case BufferEncoding::Ucs2:
-    case BufferEncoding::Utf16le:
-        str = QString::fromUtf16(reinterpret_cast<const ushort *>(startPtr), size >> 1);
-        break;
-    case BufferEncoding::Utf8:
-        str = QString::fromUtf8(data);
-        break;
-    case BufferEncoding::Invalid:
-        // Should never happen
-        break;
-    }
+    const QString str = BufferObject::decode(startPtr, size, encoding);
 
     QV4::ScopedString s(scope, v4->newString(str));
     return s->asReturnedValue();
@@ -362,7 +892,7 @@ QV4::ReturnedValue BufferPrototype::method_toJSON(QV4::CallContext *ctx)
     json.insert(QStringLiteral("type"), QStringLiteral("Buffer"));
 
     QJsonArray data;
-    for (int i = 0; i < self->d()->data.size(); ++i)
+    for (size_t i = 0; i < self->d()->data.size(); ++i)
         data.append(self->d()->data[i]);
 
     json.insert(QStringLiteral("data"), data);
@@ -383,49 +913,47 @@ QV4::ReturnedValue BufferPrototype::method_copy(QV4::CallContext *ctx)
 
     size_t targetStart = 0;
     size_t sourceStart = 0;
-    size_t sourceEnd = self->getLength();
+    size_t sourceEnd = self->d()->data.size();
 
     if (callData->argc > 1) {
         if (!callData->args[1].isNumber())
             return ctx->engine()->throwTypeError(QStringLiteral("Bad argument"));
-        if (callData->args[1].toInt32() < 0)
+        if (callData->args[1].toInteger() < 0)
             return ctx->engine()->throwRangeError(QStringLiteral("Out of range index"));
 
-        targetStart = callData->args[1].toInt32();
+        targetStart = callData->args[1].toInteger();
     }
 
     if (callData->argc > 2) {
         if (!callData->args[2].isNumber())
             return ctx->engine()->throwTypeError(QStringLiteral("Bad argument"));
-        if (callData->args[2].toInt32() < 0)
+        if (callData->args[2].toInteger() < 0)
             return ctx->engine()->throwRangeError(QStringLiteral("Out of range index"));
-        sourceStart = callData->args[2].toInt32();
+        sourceStart = callData->args[2].toInteger();
     }
 
     if (callData->argc > 3) {
         if (!callData->args[3].isNumber())
             return ctx->engine()->throwTypeError(QStringLiteral("Bad argument"));
-        if (callData->args[3].toInt32() < 0)
+        if (callData->args[3].toInteger() < 0)
             return ctx->engine()->throwRangeError(QStringLiteral("Out of range index"));
-        sourceEnd = callData->args[3].toInt32();
+        sourceEnd = callData->args[3].toInteger();
     }
 
-    qDebug("Target length: %u", target->getLength());
-
     // Copy zero bytes, we're done
-    if (targetStart >= target->getLength() || sourceStart >= sourceEnd)
+    if (targetStart >= target->d()->data.size() || sourceStart >= sourceEnd)
         return QV4::Encode(0);
 
-    if (sourceStart > self->getLength())
+    if (sourceStart > self->d()->data.size())
         return ctx->engine()->throwRangeError(QStringLiteral("copy: Out of range index"));
 
-    const size_t targetLength = target->getLength();
+    const size_t targetLength = target->d()->data.size();
     if (sourceEnd - sourceStart > targetLength - targetStart)
         sourceEnd = sourceStart + targetLength - targetStart;
     size_t to_copy = qMin(qMin(sourceEnd - sourceStart, targetLength - targetStart),
-                          self->getLength() - sourceStart);
+                          self->d()->data.size() - sourceStart);
     memmove(target->d()->data.data() + targetStart, self->d()->data.constData() + sourceStart, to_copy);
-    return QV4::Primitive::fromUInt32(to_copy).asReturnedValue();
+    return QV4::Encode(double(to_copy));
 }
 
 // fill(value, [offset], [end])
@@ -436,8 +964,9 @@ QV4::ReturnedValue BufferPrototype::method_fill(QV4::CallContext *ctx)
 
     /// TODO: SLICE_START_END (https://github.com/joyent/node/blob/master/src/node_buffer.cc#L52)
 
-    int offset = 0;
-    int end = self->d()->data.size();
+    const size_t size = self->d()->data.size();
+    double offset = 0;
+    double end = size;
 
     if (!callData->argc)
         return QV4::Encode::undefined();
@@ -445,7 +974,7 @@ QV4::ReturnedValue BufferPrototype::method_fill(QV4::CallContext *ctx)
     if (callData->argc > 1) {
         if (!callData->args[1].isNumber())
             return ctx->engine()->throwTypeError(QStringLiteral("Bad argument"));
-        offset = callData->args[1].toInt32();
+        offset = callData->args[1].toInteger();
         if (offset < 0)
             return ctx->engine()->throwRangeError(QStringLiteral("Out of range index"));
     }
@@ -453,12 +982,16 @@ QV4::ReturnedValue BufferPrototype::method_fill(QV4::CallContext *ctx)
     if (callData->argc > 2) {
         if (!callData->args[2].isNumber())
             return ctx->engine()->throwTypeError(QStringLiteral("Bad argument"));
-        end = callData->args[2].toInt32();
+        end = callData->args[2].toInteger();
         if (end < 0)
             return ctx->engine()->throwRangeError(QStringLiteral("Out of range index"));
     }
 
-    const int length = end - offset;
+    end = qMin<double>(end, size);
+    if (offset >= end)
+        return QV4::Encode::undefined();
+
+    const size_t length = size_t(end - offset);
     char * const startPtr = self->d()->data.data() + offset;
 
     if (callData->args[0].isNumber()) {
@@ -478,10 +1011,10 @@ QV4::ReturnedValue BufferPrototype::method_fill(QV4::CallContext *ctx)
         return QV4::Encode::undefined();
     }
 
-    int in_there = value.size();
+    size_t in_there = value.size();
     char * ptr = startPtr + value.size();
-    memcpy(startPtr, value.constData(), qMin(value.size(), length));
-    if (value.size() >= length)
+    memcpy(startPtr, value.constData(), qMin(in_there, length));
+    if (in_there >= length)
         return QV4::Encode::undefined();
 
     while (in_there < length - in_there) {
@@ -506,19 +1039,136 @@ QV4::ReturnedValue BufferPrototype::method_slice(QV4::CallContext *ctx)
     if (!self)
         return v4->throwTypeError();
 
-    int start = callData->argc > 0 ? callData->args[0].toInt32() : 0;
-    int end = callData->argc < 2 || callData->args[1].isUndefined()
-            ? self->d()->data.size() - 1 : callData->args[1].toInt32();
+    const double size = self->d()->data.size();
+    double start = callData->argc > 0 ? callData->args[0].toInteger() : 0;
+    double end = callData->argc < 2 || callData->args[1].isUndefined()
+            ? size - 1 : callData->args[1].toInteger();
 
     if (start < 0)
-        start = qMax(self->d()->data.size() + start, 0);
+        start = qMax<double>(size + start, 0);
     if (end < 0)
-        end = qMax(self->d()->data.size() + end, 0);
+        end = qMax<double>(size + end, 0);
 
     if (end < start)
         return v4->throwRangeError(QStringLiteral("slice: start cannot exceed end"));
 
-    QTypedArrayDataSlice<char> slice(self->d()->data, start, end - start + 1);
-    QV4::Scoped<BufferObject> newBuffer(scope, v4->memoryManager->alloc<BufferObject>(v4, slice));
+    // Ranges past the end are cut off rather than viewing foreign memory
+    end = qMin(end, size - 1);
+    QTypedArrayDataSlice<char> slice;
+    if (start <= end)
+        slice = QTypedArrayDataSlice<char>(self->d()->data, size_t(start), size_t(end - start + 1));
+    QV4::Scoped<BufferObject> newBuffer(scope, v4->memoryManager->alloc<BufferObject>(v4, &slice));
     return newBuffer->asReturnedValue();
 }
+
+// equals(otherBuffer)
+QV4::ReturnedValue BufferPrototype::method_equals(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const BufferObject *self = callData->thisObject.as<BufferObject>();
+    const BufferObject *other = callData->argc ? callData->args[0].as<BufferObject>() : nullptr;
+    if (!self || !other)
+        return v4->throwTypeError(QStringLiteral("equals: Argument must be a Buffer"));
+
+    return QV4::Encode(self->d()->data == other->d()->data);
+}
+
+// compare(otherBuffer)
+QV4::ReturnedValue BufferPrototype::method_instanceCompare(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const BufferObject *self = callData->thisObject.as<BufferObject>();
+    const BufferObject *other = callData->argc ? callData->args[0].as<BufferObject>() : nullptr;
+    if (!self || !other)
+        return v4->throwTypeError(QStringLiteral("compare: Argument must be a Buffer"));
+
+    return QV4::Encode(compareSlices(self->d()->data, other->d()->data));
+}
+
+// indexOf(value, [byteOffset], [encoding])
+QV4::ReturnedValue BufferPrototype::method_indexOf(QV4::CallContext *ctx)
+{
+    return searchBuffer(ctx);
+}
+
+// includes(value, [byteOffset], [encoding])
+QV4::ReturnedValue BufferPrototype::method_includes(QV4::CallContext *ctx)
+{
+    const QV4::ReturnedValue result = searchBuffer(ctx);
+    if (ctx->engine()->hasException)
+        return result;
+    return QV4::Encode(QV4::Value::fromReturnedValue(result).toNumber() >= 0);
+}
+
+// readXXX(offset, [noAssert])
+// No QV4::Scope is opened: nothing here allocates, and thisObject is rooted by the call data
+template <typename T, bool BigEndian>
+QV4::ReturnedValue BufferPrototype::method_readNumber(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    const BufferObject *self = callData->thisObject.as<BufferObject>();
+    if (!self)
+        return v4->throwTypeError();
+
+    const bool noAssert = callData->argc > 1 && callData->args[1].toBoolean();
+    const double offset = callData->argc ? callData->args[0].toNumber() : 0;
+    if (v4->hasException)
+        return QV4::Encode::undefined();
+
+    const size_t length = self->d()->data.size();
+    if (!noAssert) {
+        if (!(offset >= 0) || offset != std::floor(offset))
+            return v4->throwRangeError(QStringLiteral("offset is not uint"));
+        if (offset + sizeof(T) > length)
+            return v4->throwRangeError(QStringLiteral("Trying to access beyond buffer length"));
+    } else if (!(offset >= 0 && offset + sizeof(T) <= length)) {
+        // noAssert only skips validation, reads never leave the buffer
+        return QV4::Encode::undefined();
+    }
+
+    const uchar *src = reinterpret_cast<const uchar *>(self->d()->data.constData()) + size_t(offset);
+    return encodeNumber(Endian<T, BigEndian>::load(src));
+}
+
+// writeXXX(value, offset, [noAssert])
+template <typename T, bool BigEndian>
+QV4::ReturnedValue BufferPrototype::method_writeNumber(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_V4(ctx);
+
+    BufferObject *self = callData->thisObject.as<BufferObject>();
+    if (!self)
+        return v4->throwTypeError();
+
+    const bool noAssert = callData->argc > 2 && callData->args[2].toBoolean();
+    if (!noAssert && !callData->argc)
+        return v4->throwTypeError(QStringLiteral("missing value"));
+
+    const double value = callData->argc ? callData->args[0].toNumber() : 0;
+    const double offset = callData->argc > 1 ? callData->args[1].toNumber() : 0;
+    if (v4->hasException)
+        return QV4::Encode::undefined();
+
+    const size_t length = self->d()->data.size();
+    if (!noAssert) {
+        if (!(offset >= 0) || offset != std::floor(offset))
+            return v4->throwRangeError(QStringLiteral("offset is not uint"));
+        if (offset + sizeof(T) > length)
+            return v4->throwRangeError(QStringLiteral("Trying to access beyond buffer length"));
+        if (!NumberConversion<T>::inRange(value))
+            return v4->throwTypeError(QStringLiteral("value is out of bounds"));
+    } else if (!(offset >= 0 && offset + sizeof(T) <= length)) {
+        return QV4::Encode(offset + sizeof(T));
+    }
+
+    uchar *dst = reinterpret_cast<uchar *>(self->d()->data.data()) + size_t(offset);
+    Endian<T, BigEndian>::store(NumberConversion<T>::fromNumber(value), dst);
+    return QV4::Encode(double(size_t(offset) + sizeof(T)));
+}
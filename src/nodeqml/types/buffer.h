@@ -4,6 +4,8 @@
 #include "../v4integration.h"
 #include "../util/qarraydataslice.h"
 
+#include <limits>
+
 #include <private/qv4object_p.h>
 #include <private/qv4functionobject_p.h>
 
@@ -27,11 +29,20 @@ struct BufferObject : QV4::Heap::Object {
     BufferObject(QV4::ExecutionEngine *v4, size_t length);
     BufferObject(QV4::ExecutionEngine *v4, const QString &str, BufferEncoding encoding);
     BufferObject(QV4::ExecutionEngine *v4, QV4::ArrayObject *array);
-    BufferObject(QV4::ExecutionEngine *v4, const QByteArray &ba);
+    // Takes the array's storage over, leaving *ba null, if nothing else shares
+    // it; copies the data otherwise
+    BufferObject(QV4::ExecutionEngine *v4, QByteArray *ba);
+    // Wraps memory owned elsewhere; cleanupFunction runs once no slice refers to it anymore
+    BufferObject(QV4::ExecutionEngine *v4, char *external, size_t length,
+                 QExternalArrayData::CleanupFunction cleanupFunction, void *cleanupInfo);
     BufferObject(QV4::ExecutionEngine *v4, const QTypedArrayDataSlice<char> &slice);
-    bool allocateData(size_t length);
+    // Takes *slice over without touching its reference count, leaving it null
+    BufferObject(QV4::ExecutionEngine *v4, QTypedArrayDataSlice<char> *slice);
+    bool allocateData(QV4::ExecutionEngine *v4, size_t length);
 
     QTypedArrayDataSlice<char> data;
+    // Payload accounted to the engine's external memory, zero for views of other buffers
+    size_t externalSize = 0;
 };
 
 struct BufferCtor : QV4::Heap::FunctionObject {
@@ -51,6 +62,16 @@ struct BufferObject : QV4::Object
 
     static BufferEncoding parseEncoding(const QString &str);
     static bool isEncoding(const QString &str);
+
+    // Longest QString Qt 5 can allocate: the UTF-16 data plus its header must stay below 2 GB
+    static const size_t MaxStringLength = (size_t(std::numeric_limits<int>::max()) - 64) / 2;
+
+    static size_t byteLength(const QString &str, BufferEncoding encoding);
+    // Writes at most capacity bytes and returns how many were written
+    static size_t encode(const QString &str, BufferEncoding encoding, char *dst, size_t capacity);
+    // Number of UTF-16 units decode() produces, at most
+    static size_t decodedLength(size_t length, BufferEncoding encoding);
+    static QString decode(const char *src, size_t length, BufferEncoding encoding);
 };
 
 struct BufferCtor : QV4::FunctionObject
@@ -69,42 +90,28 @@ struct BufferPrototype : QV4::Object
     static QV4::ReturnedValue method_isBuffer(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_byteLength(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_concat(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_compare(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_poolStats(QV4::CallContext *ctx);
 
-    /// TODO: buf.write(string, [offset], [length], [encoding])
+    static QV4::ReturnedValue method_write(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_toString(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_toJSON(QV4::CallContext *ctx);
 
     static QV4::ReturnedValue method_copy(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_fill(QV4::CallContext *ctx);
     static QV4::ReturnedValue method_slice(QV4::CallContext *ctx);
-    /// TODO: buf.readUInt8(offset, [noAssert])
-    /// TODO: buf.readUInt16LE(offset, [noAssert])
-    /// TODO: buf.readUInt16BE(offset, [noAssert])
-    /// TODO: buf.readUInt32LE(offset, [noAssert])
-    /// TODO: buf.readUInt32BE(offset, [noAssert])
-    /// TODO: buf.readInt8(offset, [noAssert])
-    /// TODO: buf.readInt16LE(offset, [noAssert])
-    /// TODO: buf.readInt16BE(offset, [noAssert])
-    /// TODO: buf.readInt32LE(offset, [noAssert])
-    /// TODO: buf.readInt32BE(offset, [noAssert])
-    /// TODO: buf.readFloatLE(offset, [noAssert])
-    /// TODO: buf.readFloatBE(offset, [noAssert])
-    /// TODO: buf.readDoubleLE(offset, [noAssert])
-    /// TODO: buf.readDoubleBE(offset, [noAssert])
-    /// TODO: buf.writeUInt8(value, offset, [noAssert])
-    /// TODO: buf.writeUInt16LE(value, offset, [noAssert])
-    /// TODO: buf.writeUInt16BE(value, offset, [noAssert])
-    /// TODO: buf.writeUInt32LE(value, offset, [noAssert])
-    /// TODO: buf.writeUInt32BE(value, offset, [noAssert])
-    /// TODO: buf.writeInt8(value, offset, [noAssert])
-    /// TODO: buf.writeInt16LE(value, offset, [noAssert])
-    /// TODO: buf.writeInt16BE(value, offset, [noAssert])
-    /// TODO: buf.writeInt32LE(value, offset, [noAssert])
-    /// TODO: buf.writeInt32BE(value, offset, [noAssert])
-    /// TODO: buf.writeFloatLE(value, offset, [noAssert])
-    /// TODO: buf.writeFloatBE(value, offset, [noAssert])
-    /// TODO: buf.writeDoubleLE(value, offset, [noAssert])
-    /// TODO: buf.writeDoubleBE(value, offset, [noAssert])
+
+    static QV4::ReturnedValue method_equals(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_instanceCompare(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_indexOf(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_includes(QV4::CallContext *ctx);
+
+    // readUInt8(offset, [noAssert]) ... readDoubleBE(offset, [noAssert]), plus 64-bit integer variants returning doubles
+    template <typename T, bool BigEndian>
+    static QV4::ReturnedValue method_readNumber(QV4::CallContext *ctx);
+    // writeUInt8(value, offset, [noAssert]) ... writeDoubleBE(value, offset, [noAssert])
+    template <typename T, bool BigEndian>
+    static QV4::ReturnedValue method_writeNumber(QV4::CallContext *ctx);
 };
 
 } // namespace NodeQml
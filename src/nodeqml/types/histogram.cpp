@@ -0,0 +1,175 @@
+#include "histogram.h"
+
+#include "../engine_p.h"
+#include "../eventloopmonitor.h"
+
+#include <private/qv4context_p.h>
+
+using namespace NodeQml;
+
+DEFINE_OBJECT_VTABLE(HistogramObject);
+
+Heap::HistogramObject::HistogramObject(QV4::ExecutionEngine *v4, int samplingResolution) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->histogramClass),
+    histogram(new HdrHistogram()),
+    resolution(samplingResolution)
+{
+    setVTable(NodeQml::HistogramObject::staticVTable());
+}
+
+void HistogramObject::destroy(QV4::Managed *m)
+{
+    Heap::HistogramObject *o = static_cast<HistogramObject *>(m)->d();
+
+    EnginePrivate *node = EnginePrivate::get(m->engine());
+    if (o->enabled && node)
+        node->loopMonitor()->stopSampling(o->histogram);
+
+    delete o->histogram;
+    o->histogram = nullptr;
+}
+
+void HistogramPrototype::init(QV4::ExecutionEngine *v4)
+{
+    Q_UNUSED(v4)
+
+    defineDefaultProperty(QStringLiteral("enable"), method_enable);
+    defineDefaultProperty(QStringLiteral("disable"), method_disable);
+    defineDefaultProperty(QStringLiteral("reset"), method_reset);
+    defineDefaultProperty(QStringLiteral("percentile"), method_percentile, 1);
+
+    defineAccessorProperty(QStringLiteral("min"), property_min_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("max"), property_max_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("mean"), property_mean_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("stddev"), property_stddev_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("count"), property_count_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("exceeds"), property_exceeds_getter, nullptr);
+    defineAccessorProperty(QStringLiteral("percentiles"), property_percentiles_getter, nullptr);
+}
+
+QV4::ReturnedValue HistogramPrototype::method_enable(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    if (self->d()->enabled)
+        return QV4::Encode(false);
+
+    self->d()->enabled = true;
+    EnginePrivate::get(ctx->engine())->loopMonitor()->startSampling(self->d()->histogram,
+                                                                     self->d()->resolution);
+    return QV4::Encode(true);
+}
+
+QV4::ReturnedValue HistogramPrototype::method_disable(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    if (!self->d()->enabled)
+        return QV4::Encode(false);
+
+    self->d()->enabled = false;
+    EnginePrivate::get(ctx->engine())->loopMonitor()->stopSampling(self->d()->histogram);
+    return QV4::Encode(true);
+}
+
+QV4::ReturnedValue HistogramPrototype::method_reset(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    self->d()->histogram->reset();
+    return QV4::Encode::undefined();
+}
+
+QV4::ReturnedValue HistogramPrototype::method_percentile(QV4::CallContext *ctx)
+{
+    NODE_CTX_CALLDATA(ctx);
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    if (!callData->argc || !callData->args[0].isNumber())
+        return ctx->engine()->throwTypeError(QStringLiteral("percentile: argument must be a number"));
+
+    const double percentile = callData->args[0].toNumber();
+    if (!(percentile > 0 && percentile <= 100))
+        return ctx->engine()->throwRangeError(QStringLiteral("percentile: argument must be > 0 and <= 100"));
+
+    return QV4::Encode(double(self->d()->histogram->valueAtPercentile(percentile)));
+}
+
+QV4::ReturnedValue HistogramPrototype::property_min_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(double(self->d()->histogram->min()));
+}
+
+QV4::ReturnedValue HistogramPrototype::property_max_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(double(self->d()->histogram->max()));
+}
+
+QV4::ReturnedValue HistogramPrototype::property_mean_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(self->d()->histogram->mean());
+}
+
+QV4::ReturnedValue HistogramPrototype::property_stddev_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(self->d()->histogram->stddev());
+}
+
+QV4::ReturnedValue HistogramPrototype::property_count_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(double(self->d()->histogram->count()));
+}
+
+QV4::ReturnedValue HistogramPrototype::property_exceeds_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+    return QV4::Encode(double(self->d()->histogram->exceeds()));
+}
+
+// Plain object instead of a Map: { "50": value, "75": value, ... }
+QV4::ReturnedValue HistogramPrototype::property_percentiles_getter(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(HistogramObject, ctx);
+    NODE_CTX_V4(ctx);
+    if (!self)
+        return v4->throwTypeError();
+
+    static const double percentiles[] = { 0, 50, 75, 90, 99, 99.9, 100 };
+
+    QV4::ScopedObject result(scope, v4->newObject());
+    QV4::ScopedString s(scope);
+    QV4::ScopedValue v(scope);
+
+    for (double percentile : percentiles) {
+        s = v4->newString(QString::number(percentile));
+        v = QV4::Primitive::fromDouble(self->d()->histogram->valueAtPercentile(percentile));
+        result->insertMember(s.getPointer(), v);
+    }
+
+    return result->asReturnedValue();
+}
@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "../v4integration.h"
+#include "../util/hdrhistogram.h"
+
+#include <private/qv4object_p.h>
+
+namespace NodeQml {
+
+namespace Heap {
+
+struct HistogramObject : QV4::Heap::Object {
+    HistogramObject(QV4::ExecutionEngine *v4, int samplingResolution);
+
+    HdrHistogram *histogram;
+    int resolution;
+    bool enabled = false;
+};
+
+} // namespace Heap
+
+struct HistogramObject : QV4::Object
+{
+    NODE_V4_OBJECT(HistogramObject, Object)
+
+    static void destroy(QV4::Managed *m);
+};
+
+struct HistogramPrototype : QV4::Object
+{
+    void init(QV4::ExecutionEngine *v4);
+
+    static QV4::ReturnedValue method_enable(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_disable(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_reset(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_percentile(QV4::CallContext *ctx);
+
+    static QV4::ReturnedValue property_min_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_max_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_mean_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_stddev_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_count_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_exceeds_getter(QV4::CallContext *ctx);
+    static QV4::ReturnedValue property_percentiles_getter(QV4::CallContext *ctx);
+};
+
+} // namespace NodeQml
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,69 @@
+#include "immediate.h"
+
+#include "../engine_p.h"
+
+#include <private/qv4context_p.h>
+
+using namespace NodeQml;
+
+DEFINE_OBJECT_VTABLE(ImmediateObject);
+
+Heap::ImmediateObject::ImmediateObject(QV4::ExecutionEngine *v4, QV4::FunctionObject *immediateCallback,
+                                       QV4::ArrayObject *callbackArguments) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->immediateClass),
+    callback(immediateCallback),
+    arguments(callbackArguments)
+{
+    setVTable(NodeQml::ImmediateObject::staticVTable());
+}
+
+void ImmediateObject::markObjects(QV4::Heap::Base *that, QV4::ExecutionEngine *e)
+{
+    Heap::ImmediateObject *o = static_cast<Heap::ImmediateObject *>(that);
+    if (o->callback)
+        o->callback->mark(e);
+    if (o->arguments)
+        o->arguments->mark(e);
+
+    Object::markObjects(that, e);
+}
+
+void ImmediatePrototype::init(QV4::ExecutionEngine *v4)
+{
+    Q_UNUSED(v4)
+
+    defineDefaultProperty(QStringLiteral("ref"), method_ref);
+    defineDefaultProperty(QStringLiteral("unref"), method_unref);
+    defineDefaultProperty(QStringLiteral("hasRef"), method_hasRef);
+}
+
+QV4::ReturnedValue ImmediatePrototype::method_ref(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(ImmediateObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    self->d()->hasRef = true;
+    EnginePrivate::get(ctx->engine())->updateImmediateRef(self->d());
+    return self.asReturnedValue();
+}
+
+QV4::ReturnedValue ImmediatePrototype::method_unref(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(ImmediateObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    self->d()->hasRef = false;
+    EnginePrivate::get(ctx->engine())->updateImmediateRef(self->d());
+    return self.asReturnedValue();
+}
+
+QV4::ReturnedValue ImmediatePrototype::method_hasRef(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(ImmediateObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    return QV4::Encode(self->d()->hasRef);
+}
@@ -0,0 +1,45 @@
+#ifndef IMMEDIATE_H
+#define IMMEDIATE_H
+
+#include "../v4integration.h"
+
+#include <private/qv4object_p.h>
+
+namespace NodeQml {
+
+namespace Heap {
+
+struct ImmediateObject : QV4::Heap::Object {
+    ImmediateObject(QV4::ExecutionEngine *v4, QV4::FunctionObject *immediateCallback,
+                    QV4::ArrayObject *callbackArguments = nullptr);
+
+    QV4::FunctionObject *callback;
+    QV4::ArrayObject *arguments;
+
+    // Cleared immediates stay in the queue and are skipped when it is drained
+    bool active = true;
+    bool hasRef = true;
+    bool counted = false;
+};
+
+} // namespace Heap
+
+struct ImmediateObject : QV4::Object
+{
+    NODE_V4_OBJECT(ImmediateObject, Object)
+
+    static void markObjects(QV4::Heap::Base *that, QV4::ExecutionEngine *e);
+};
+
+struct ImmediatePrototype : QV4::Object
+{
+    void init(QV4::ExecutionEngine *v4);
+
+    static QV4::ReturnedValue method_ref(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_unref(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_hasRef(QV4::CallContext *ctx);
+};
+
+} // namespace NodeQml
+
+#endif // IMMEDIATE_H
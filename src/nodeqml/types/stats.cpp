@@ -0,0 +1,115 @@
+#include "stats.h"
+
+#include "../engine_p.h"
+
+#include <private/qv4context_p.h>
+#include <private/qv4dateobject_p.h>
+
+using namespace NodeQml;
+
+namespace {
+
+inline double toMSecs(const struct timespec &ts)
+{
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+}
+
+#if defined(Q_OS_DARWIN)
+#define NODEQML_STAT_TIME(st, field) toMSecs(st.st_##field##timespec)
+#else
+#define NODEQML_STAT_TIME(st, field) toMSecs(st.st_##field##tim)
+#endif
+
+DEFINE_OBJECT_VTABLE(StatsObject);
+
+Heap::StatsObject::StatsObject(QV4::ExecutionEngine *v4, const struct stat &st) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->statsClass),
+    mode(st.st_mode)
+{
+    setVTable(NodeQml::StatsObject::staticVTable());
+
+    QV4::Scope scope(v4);
+    QV4::ScopedObject self(scope, this);
+    QV4::ScopedValue v(scope);
+
+    self->defineDefaultProperty(QStringLiteral("dev"), (v = QV4::Primitive::fromDouble(st.st_dev)));
+    self->defineDefaultProperty(QStringLiteral("ino"), (v = QV4::Primitive::fromDouble(st.st_ino)));
+    self->defineDefaultProperty(QStringLiteral("mode"), (v = QV4::Primitive::fromDouble(st.st_mode)));
+    self->defineDefaultProperty(QStringLiteral("nlink"), (v = QV4::Primitive::fromDouble(st.st_nlink)));
+    self->defineDefaultProperty(QStringLiteral("uid"), (v = QV4::Primitive::fromDouble(st.st_uid)));
+    self->defineDefaultProperty(QStringLiteral("gid"), (v = QV4::Primitive::fromDouble(st.st_gid)));
+    self->defineDefaultProperty(QStringLiteral("rdev"), (v = QV4::Primitive::fromDouble(st.st_rdev)));
+    self->defineDefaultProperty(QStringLiteral("size"), (v = QV4::Primitive::fromDouble(st.st_size)));
+    self->defineDefaultProperty(QStringLiteral("blksize"), (v = QV4::Primitive::fromDouble(st.st_blksize)));
+    self->defineDefaultProperty(QStringLiteral("blocks"), (v = QV4::Primitive::fromDouble(st.st_blocks)));
+
+    const double atime = NODEQML_STAT_TIME(st, a);
+    const double mtime = NODEQML_STAT_TIME(st, m);
+    const double ctime = NODEQML_STAT_TIME(st, c);
+
+    self->defineDefaultProperty(QStringLiteral("atimeMs"), (v = QV4::Primitive::fromDouble(atime)));
+    self->defineDefaultProperty(QStringLiteral("mtimeMs"), (v = QV4::Primitive::fromDouble(mtime)));
+    self->defineDefaultProperty(QStringLiteral("ctimeMs"), (v = QV4::Primitive::fromDouble(ctime)));
+    self->defineDefaultProperty(QStringLiteral("atime"), (v = v4->newDateObject(QV4::Primitive::fromDouble(atime))));
+    self->defineDefaultProperty(QStringLiteral("mtime"), (v = v4->newDateObject(QV4::Primitive::fromDouble(mtime))));
+    self->defineDefaultProperty(QStringLiteral("ctime"), (v = v4->newDateObject(QV4::Primitive::fromDouble(ctime))));
+}
+
+void StatsPrototype::init(QV4::ExecutionEngine *v4)
+{
+    Q_UNUSED(v4)
+
+    defineDefaultProperty(QStringLiteral("isFile"), method_isFile);
+    defineDefaultProperty(QStringLiteral("isDirectory"), method_isDirectory);
+    defineDefaultProperty(QStringLiteral("isBlockDevice"), method_isBlockDevice);
+    defineDefaultProperty(QStringLiteral("isCharacterDevice"), method_isCharacterDevice);
+    defineDefaultProperty(QStringLiteral("isSymbolicLink"), method_isSymbolicLink);
+    defineDefaultProperty(QStringLiteral("isFIFO"), method_isFIFO);
+    defineDefaultProperty(QStringLiteral("isSocket"), method_isSocket);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isFile(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFREG);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isDirectory(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFDIR);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isBlockDevice(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFBLK);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isCharacterDevice(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFCHR);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isSymbolicLink(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFLNK);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isFIFO(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFIFO);
+}
+
+QV4::ReturnedValue StatsPrototype::method_isSocket(QV4::CallContext *ctx)
+{
+    return testMode(ctx, S_IFSOCK);
+}
+
+QV4::ReturnedValue StatsPrototype::testMode(QV4::CallContext *ctx, mode_t type)
+{
+    NODE_CTX_SELF(StatsObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    return QV4::Encode((self->d()->mode & S_IFMT) == type);
+}
@@ -0,0 +1,45 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "../v4integration.h"
+
+#include <private/qv4object_p.h>
+
+#include <sys/stat.h>
+
+namespace NodeQml {
+
+namespace Heap {
+
+struct StatsObject : QV4::Heap::Object {
+    StatsObject(QV4::ExecutionEngine *v4, const struct stat &st);
+
+    mode_t mode;
+};
+
+} // namespace Heap
+
+struct StatsObject : QV4::Object
+{
+    NODE_V4_OBJECT(StatsObject, Object)
+};
+
+struct StatsPrototype : QV4::Object
+{
+    void init(QV4::ExecutionEngine *v4);
+
+    static QV4::ReturnedValue method_isFile(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isDirectory(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isBlockDevice(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isCharacterDevice(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isSymbolicLink(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isFIFO(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_isSocket(QV4::CallContext *ctx);
+
+private:
+    static QV4::ReturnedValue testMode(QV4::CallContext *ctx, mode_t type);
+};
+
+} // namespace NodeQml
+
+#endif // STATS_H
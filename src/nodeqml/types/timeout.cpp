@@ -0,0 +1,89 @@
+#include "timeout.h"
+
+#include "../engine_p.h"
+
+#include <private/qv4context_p.h>
+
+using namespace NodeQml;
+
+DEFINE_OBJECT_VTABLE(TimeoutObject);
+
+Heap::TimeoutObject::TimeoutObject(QV4::ExecutionEngine *v4, QV4::FunctionObject *timeoutCallback,
+                                   int timeoutDelay, bool isRepeating,
+                                   QV4::ArrayObject *callbackArguments) :
+    QV4::Heap::Object(EnginePrivate::get(v4)->timeoutClass),
+    callback(timeoutCallback),
+    arguments(callbackArguments),
+    delay(timeoutDelay),
+    repeat(isRepeating)
+{
+    setVTable(NodeQml::TimeoutObject::staticVTable());
+}
+
+void TimeoutObject::markObjects(QV4::Heap::Base *that, QV4::ExecutionEngine *e)
+{
+    Heap::TimeoutObject *o = static_cast<Heap::TimeoutObject *>(that);
+    if (o->callback)
+        o->callback->mark(e);
+    if (o->arguments)
+        o->arguments->mark(e);
+
+    Object::markObjects(that, e);
+}
+
+void TimeoutObject::destroy(QV4::Managed *m)
+{
+    static_cast<TimeoutObject *>(m)->d()->~Data();
+}
+
+void TimeoutPrototype::init(QV4::ExecutionEngine *v4)
+{
+    Q_UNUSED(v4)
+
+    defineDefaultProperty(QStringLiteral("ref"), method_ref);
+    defineDefaultProperty(QStringLiteral("unref"), method_unref);
+    defineDefaultProperty(QStringLiteral("hasRef"), method_hasRef);
+    defineDefaultProperty(QStringLiteral("refresh"), method_refresh);
+}
+
+QV4::ReturnedValue TimeoutPrototype::method_ref(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(TimeoutObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    self->d()->hasRef = true;
+    EnginePrivate::get(ctx->engine())->updateTimerRef(self->d());
+    return self.asReturnedValue();
+}
+
+QV4::ReturnedValue TimeoutPrototype::method_unref(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(TimeoutObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    self->d()->hasRef = false;
+    EnginePrivate::get(ctx->engine())->updateTimerRef(self->d());
+    return self.asReturnedValue();
+}
+
+QV4::ReturnedValue TimeoutPrototype::method_hasRef(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(TimeoutObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    return QV4::Encode(self->d()->hasRef);
+}
+
+// Re-arms the timer in place: no allocation, the wheel node is just relinked
+QV4::ReturnedValue TimeoutPrototype::method_refresh(QV4::CallContext *ctx)
+{
+    NODE_CTX_SELF(TimeoutObject, ctx);
+    if (!self)
+        return ctx->engine()->throwTypeError();
+
+    EnginePrivate::get(ctx->engine())->armTimer(self->d());
+    return self.asReturnedValue();
+}
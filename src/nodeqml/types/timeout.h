@@ -0,0 +1,53 @@
+#ifndef TIMEOUT_H
+#define TIMEOUT_H
+
+#include "../v4integration.h"
+#include "../util/timerwheel.h"
+
+#include <private/qv4object_p.h>
+#include <private/qv4persistent_p.h>
+
+namespace NodeQml {
+
+namespace Heap {
+
+struct TimeoutObject : QV4::Heap::Object, TimerWheel::Node {
+    TimeoutObject(QV4::ExecutionEngine *v4, QV4::FunctionObject *timeoutCallback, int timeoutDelay,
+                  bool isRepeating, QV4::ArrayObject *callbackArguments = nullptr);
+
+    QV4::FunctionObject *callback;
+    QV4::ArrayObject *arguments;
+    int delay;
+    bool repeat;
+
+    bool active = false;
+    bool hasRef = true;
+    bool counted = false;
+
+    // Keeps an active timer alive while no JS reference to it remains
+    QV4::PersistentValue keepAlive;
+};
+
+} // namespace Heap
+
+struct TimeoutObject : QV4::Object
+{
+    NODE_V4_OBJECT(TimeoutObject, Object)
+
+    static void markObjects(QV4::Heap::Base *that, QV4::ExecutionEngine *e);
+    static void destroy(QV4::Managed *m);
+};
+
+struct TimeoutPrototype : QV4::Object
+{
+    void init(QV4::ExecutionEngine *v4);
+
+    static QV4::ReturnedValue method_ref(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_unref(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_hasRef(QV4::CallContext *ctx);
+    static QV4::ReturnedValue method_refresh(QV4::CallContext *ctx);
+};
+
+} // namespace NodeQml
+
+#endif // TIMEOUT_H
@@ -0,0 +1,88 @@
+#include "bufferpool.h"
+
+#include <cstdlib>
+
+using namespace NodeQml;
+
+namespace {
+
+void freeData(void *data, void *info)
+{
+    Q_UNUSED(info)
+    ::free(data);
+}
+
+}
+
+BufferPool::~BufferPool()
+{
+    // Slices handed out keep the slab alive on their own
+    if (m_slab && !m_slab->ref.deref())
+        QTypedArrayData<char>::deallocate(m_slab);
+}
+
+bool BufferPool::allocate(size_t length, QTypedArrayDataSlice<char> *slice)
+{
+    ++m_statistics.allocations;
+
+    if (!length)
+        return true;
+
+    // QArrayData sizes are ints, so huge buffers are plain malloc'd memory
+    if (length > MaxArrayDataLength) {
+        char *memory = static_cast<char *>(::malloc(length));
+        if (!memory)
+            return false;
+
+        QTypedArrayData<char> *arrayData = QExternalArrayData::create(memory, length, freeData, nullptr);
+        slice->setData(arrayData);
+        arrayData->ref.deref(); // Disown data
+        return true;
+    }
+
+    if (length >= Threshold) {
+        QTypedArrayData<char> *arrayData = QTypedArrayData<char>::allocate(length + 1);
+        if (!arrayData)
+            return false;
+        arrayData->size = length;
+
+        slice->setData(arrayData);
+        arrayData->ref.deref(); // Disown data
+        return true;
+    }
+
+    size_t offset = (m_offset + Alignment - 1) & ~(Alignment - 1);
+    if (!m_slab || offset + length > SlabSize) {
+        if (!newSlab())
+            return false;
+        offset = 0;
+    }
+
+    m_statistics.wastedBytes += offset - m_offset;
+    ++m_statistics.pooledAllocations;
+    m_statistics.pooledBytes += length;
+
+    slice->setData(m_slab, offset, length);
+    m_offset = offset + length;
+    return true;
+}
+
+bool BufferPool::newSlab()
+{
+    QTypedArrayData<char> *slab = QTypedArrayData<char>::allocate(SlabSize);
+    if (!slab)
+        return false;
+    slab->size = SlabSize;
+
+    if (m_slab) {
+        m_statistics.wastedBytes += SlabSize - m_offset;
+        if (!m_slab->ref.deref())
+            QTypedArrayData<char>::deallocate(m_slab);
+    }
+
+    // The pool holds the initial reference until it moves on to the next slab
+    m_slab = slab;
+    m_offset = 0;
+    ++m_statistics.slabs;
+    return true;
+}
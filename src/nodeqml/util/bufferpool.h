@@ -0,0 +1,49 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include "qarraydataslice.h"
+
+namespace NodeQml {
+
+/// Allocator for buffer storage. Like node's Buffer.poolSize, requests below
+/// Threshold are carved out of a shared, refcounted 8 KB slab so that small
+/// buffers cost a bump of the offset instead of a malloc. A slab is freed once
+/// the pool has moved on and the last slice into it is gone; larger requests
+/// get their own allocation.
+class BufferPool
+{
+public:
+    static const size_t SlabSize = 8 * 1024;
+    static const size_t Threshold = SlabSize / 2;
+    static const size_t Alignment = 8;
+    static const size_t MaxArrayDataLength = 1 << 30;
+
+    struct Statistics {
+        quint64 allocations = 0;
+        quint64 pooledAllocations = 0;
+        quint64 pooledBytes = 0;
+        quint64 slabs = 0;
+        // Alignment padding plus the unused tails of retired slabs
+        quint64 wastedBytes = 0;
+    };
+
+    BufferPool() {}
+    ~BufferPool();
+
+    bool allocate(size_t length, QTypedArrayDataSlice<char> *slice);
+
+    const Statistics &statistics() const { return m_statistics; }
+
+private:
+    Q_DISABLE_COPY(BufferPool)
+
+    bool newSlab();
+
+    QTypedArrayData<char> *m_slab = nullptr;
+    size_t m_offset = 0;
+    Statistics m_statistics;
+};
+
+} // namespace NodeQml
+
+#endif // BUFFERPOOL_H
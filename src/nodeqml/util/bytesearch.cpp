@@ -0,0 +1,91 @@
+#include "bytesearch.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace NodeQml;
+
+namespace {
+
+size_t horspool(const uchar *haystack, size_t length, const uchar *needle, size_t needleLength)
+{
+    size_t skip[256];
+    for (int c = 0; c < 256; ++c)
+        skip[c] = needleLength;
+    for (size_t i = 0; i + 1 < needleLength; ++i)
+        skip[needle[i]] = needleLength - 1 - i;
+
+    const uchar last = needle[needleLength - 1];
+    for (size_t i = 0; i + needleLength <= length; i += skip[haystack[i + needleLength - 1]]) {
+        if (haystack[i + needleLength - 1] == last && !memcmp(haystack + i, needle, needleLength - 1))
+            return i;
+    }
+    return ByteSearch::NotFound;
+}
+
+#ifdef __SSE2__
+
+// Tests 16 candidate positions per step; *end is where the scalar tail has to resume
+size_t firstLastSse2(const uchar *haystack, size_t length, const uchar *needle, size_t needleLength, size_t *end)
+{
+    const __m128i first = _mm_set1_epi8(char(needle[0]));
+    const __m128i last = _mm_set1_epi8(char(needle[needleLength - 1]));
+
+    size_t i = 0;
+    for (; i + needleLength - 1 + 16 <= length; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needleLength - 1));
+        uint mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            const size_t candidate = i + __builtin_ctz(mask);
+            if (!memcmp(haystack + candidate + 1, needle + 1, needleLength - 2))
+                return candidate;
+            mask &= mask - 1;
+        }
+    }
+
+    *end = i;
+    return ByteSearch::NotFound;
+}
+
+#endif
+
+}
+
+size_t ByteSearch::indexOf(const uchar *haystack, size_t length, const uchar *needle, size_t needleLength)
+{
+    if (!needleLength)
+        return 0;
+    if (needleLength > length)
+        return NotFound;
+
+    if (needleLength == 1) {
+        const void *match = memchr(haystack, needle[0], length);
+        return match ? static_cast<const uchar *>(match) - haystack : NotFound;
+    }
+
+    if (needleLength > HorspoolThreshold)
+        return horspool(haystack, length, needle, needleLength);
+
+    size_t i = 0;
+#ifdef __SSE2__
+    const size_t found = firstLastSse2(haystack, length, needle, needleLength, &i);
+    if (found != NotFound)
+        return found;
+#endif
+
+    const uchar last = needle[needleLength - 1];
+    while (i + needleLength <= length) {
+        const void *match = memchr(haystack + i, needle[0], length - needleLength + 1 - i);
+        if (!match)
+            break;
+        i = static_cast<const uchar *>(match) - haystack;
+        if (haystack[i + needleLength - 1] == last && !memcmp(haystack + i + 1, needle + 1, needleLength - 2))
+            return i;
+        ++i;
+    }
+    return NotFound;
+}
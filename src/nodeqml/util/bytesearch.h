@@ -0,0 +1,26 @@
+#ifndef BYTESEARCH_H
+#define BYTESEARCH_H
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+namespace NodeQml {
+
+/// Substring search over raw memory. Short needles are located with an SSE2
+/// scan for their first and last byte, confirmed with memcmp; needles longer
+/// than HorspoolThreshold use Boyer-Moore-Horspool, whose skips grow with the
+/// needle.
+namespace ByteSearch {
+
+const size_t NotFound = size_t(-1);
+const size_t HorspoolThreshold = 32;
+
+/// Returns the offset of the first occurrence, 0 for an empty needle.
+size_t indexOf(const uchar *haystack, size_t length, const uchar *needle, size_t needleLength);
+
+} // namespace ByteSearch
+
+} // namespace NodeQml
+
+#endif // BYTESEARCH_H
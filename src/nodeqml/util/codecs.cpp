@@ -0,0 +1,654 @@
+#include "codecs.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NODEQML_CODECS_X86
+#include <immintrin.h>
+#endif
+
+using namespace NodeQml;
+
+namespace {
+
+const char hexDigits[] = "0123456789abcdef";
+const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+inline int unhex(ushort c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+inline int unbase64(ushort c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+' || c == '-')
+        return 62;
+    if (c == '/' || c == '_')
+        return 63;
+    return -1;
+}
+
+#ifdef NODEQML_CODECS_X86
+
+struct CpuFeatures
+{
+    CpuFeatures()
+    {
+        __builtin_cpu_init();
+        sse2 = __builtin_cpu_supports("sse2");
+        ssse3 = __builtin_cpu_supports("ssse3");
+        avx2 = __builtin_cpu_supports("avx2");
+    }
+
+    bool sse2;
+    bool ssse3;
+    bool avx2;
+};
+
+const CpuFeatures &cpu()
+{
+    static const CpuFeatures features;
+    return features;
+}
+
+// SSE2 is part of x86-64, but 32-bit builds may target CPUs without it
+inline bool hasSse2()
+{
+#ifdef __SSE2__
+    return true;
+#else
+    return cpu().sse2;
+#endif
+}
+
+// All kernels return how much of the input they consumed; the caller finishes the tail
+
+__attribute__((target("sse2")))
+size_t asciiPrefixLength(const ushort *src, size_t length)
+{
+    const __m128i nonAscii = _mm_set1_epi16(short(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+        const __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+            break;
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t asciiEncodeSse2(const ushort *src, size_t length, uchar *dst, size_t capacity)
+{
+    const __m128i nonAscii = _mm_set1_epi16(short(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= length && i + 16 <= capacity; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+        const __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t latin1EncodeSse2(const ushort *src, size_t length, uchar *dst)
+{
+    const __m128i lowByte = _mm_set1_epi16(0x00ff);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), lowByte);
+        const __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8)), lowByte);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+inline __m128i nibblesToHexSse2(__m128i nibbles)
+{
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                          _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+__attribute__((target("sse2")))
+size_t hexEncodeSse2(const uchar *src, size_t length, ushort *dst)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        const __m128i lo = _mm_and_si128(v, mask);
+
+        const __m128i a = nibblesToHexSse2(_mm_unpacklo_epi8(hi, lo));
+        const __m128i b = nibblesToHexSse2(_mm_unpackhi_epi8(hi, lo));
+
+        __m128i *out = reinterpret_cast<__m128i *>(dst + i * 2);
+        _mm_storeu_si128(out, _mm_unpacklo_epi8(a, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(a, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi8(b, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi8(b, zero));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i nibblesToHexAvx2(__m256i nibbles)
+{
+    const __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)),
+                                             _mm256_set1_epi8('a' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), letters);
+}
+
+__attribute__((target("avx2")))
+size_t hexEncodeAvx2(const uchar *src, size_t length, ushort *dst)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+        const __m256i lo = _mm256_and_si256(v, mask);
+
+        // Unpacking works per 128-bit lane: a holds bytes 0-7 and 16-23, b holds 8-15 and 24-31
+        const __m256i a = nibblesToHexAvx2(_mm256_unpacklo_epi8(hi, lo));
+        const __m256i b = nibblesToHexAvx2(_mm256_unpackhi_epi8(hi, lo));
+
+        __m256i *out = reinterpret_cast<__m256i *>(dst + i * 2);
+        _mm256_storeu_si256(out, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)));
+        _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b)));
+        _mm256_storeu_si256(out + 2, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1)));
+        _mm256_storeu_si256(out + 3, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1)));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t hexDecodeSse2(const ushort *src, size_t length, uchar *dst)
+{
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        // Code units above 0xff saturate to 0xff, which is rejected below
+        const __m128i c = _mm_packus_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8)));
+
+        const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        const __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xffff)
+            break;
+
+        const __m128i value = _mm_or_si128(_mm_and_si128(isDigit, digit),
+                                           _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+        const __m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(0x00ff)), 4),
+                                           _mm_srli_epi16(value, 8));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i / 2), _mm_packus_epi16(bytes, bytes));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t hexDecodeAvx2(const ushort *src, size_t length, uchar *dst)
+{
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i c = _mm256_packus_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16)));
+        c = _mm256_permute4x64_epi64(c, 0xd8);
+
+        const __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        const __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isAlpha)) != -1)
+            break;
+
+        const __m256i value = _mm256_or_si256(_mm256_and_si256(isDigit, digit),
+                                              _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+        const __m256i bytes = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(value, _mm256_set1_epi16(0x00ff)), 4),
+                                              _mm256_srli_epi16(value, 8));
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(bytes, bytes), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i / 2), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+// Base64 encoding after Wojciech Muła's "Base64 encoding with SIMD instructions"
+
+__attribute__((target("ssse3")))
+inline __m128i base64LookupSsse3(__m128i indices)
+{
+    const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(shift, result), indices);
+}
+
+__attribute__((target("ssse3")))
+size_t base64EncodeSsse3(const uchar *src, size_t length, ushort *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    // 12 bytes are consumed per step, but 16 are loaded
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= length; i += 12, o += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i chars = base64LookupSsse3(_mm_or_si128(t1, t3));
+
+        __m128i *out = reinterpret_cast<__m128i *>(dst + o);
+        _mm_storeu_si128(out, _mm_unpacklo_epi8(chars, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(chars, zero));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256i base64LookupAvx2(__m256i indices)
+{
+    const __m256i shift = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0,
+                                           'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0);
+
+    __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(shift, result), indices);
+}
+
+__attribute__((target("avx2")))
+size_t base64EncodeAvx2(const uchar *src, size_t length, ushort *dst)
+{
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+    // Each lane takes 12 of the 24 bytes consumed per step
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 28 <= length; i += 24, o += 32) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i chars = base64LookupAvx2(_mm256_or_si256(t1, t3));
+
+        __m256i *out = reinterpret_cast<__m256i *>(dst + o);
+        _mm256_storeu_si256(out, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chars)));
+        _mm256_storeu_si256(out + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chars, 1)));
+    }
+    return i;
+}
+
+// Maps base64 characters to sextets; any other byte clears the returned mask bit
+__attribute__((target("sse2")))
+inline __m128i base64TranslateSse2(__m128i c, int *validMask)
+{
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    const __m128i plus = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('+')),
+                                      _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+    const __m128i slash = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('/')),
+                                       _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+
+    *validMask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(upper, lower),
+                                                _mm_or_si128(_mm_or_si128(digit, plus), slash)));
+
+    __m128i value = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+    value = _mm_or_si128(value, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+    value = _mm_or_si128(value, _mm_and_si128(digit, _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+    value = _mm_or_si128(value, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    return _mm_or_si128(value, _mm_and_si128(slash, _mm_set1_epi8(63)));
+}
+
+__attribute__((target("sse2")))
+size_t base64DecodeSse2(const ushort *src, size_t length, uchar *dst, size_t capacity)
+{
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 16 <= length && o + 12 <= capacity; i += 16, o += 12) {
+        const __m128i c = _mm_packus_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8)));
+        int validMask;
+        const __m128i sextets = base64TranslateSse2(c, &validMask);
+        if (validMask != 0xffff)
+            break;
+
+        // Merge sextet pairs into 12 bits, then 12-bit pairs into 24 bits per dword
+        const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00ff)), 6),
+                                           _mm_srli_epi16(sextets, 8));
+        const __m128i triples = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0xffff)), 12),
+                                             _mm_srli_epi32(pairs, 16));
+
+        quint32 words[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(words), triples);
+        for (int k = 0; k < 4; ++k) {
+            dst[o + k * 3] = words[k] >> 16;
+            dst[o + k * 3 + 1] = words[k] >> 8;
+            dst[o + k * 3 + 2] = words[k];
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t base64DecodeAvx2(const ushort *src, size_t length, uchar *dst, size_t capacity)
+{
+    const __m256i compact = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                             2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    size_t o = 0;
+    for (; i + 32 <= length && o + 24 <= capacity; i += 32, o += 24) {
+        __m256i c = _mm256_packus_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16)));
+        c = _mm256_permute4x64_epi64(c, 0xd8);
+
+        const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+        const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+        const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        const __m256i plus = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('+')),
+                                             _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+        const __m256i slash = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('/')),
+                                              _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+
+        const __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                              _mm256_or_si256(_mm256_or_si256(digit, plus), slash));
+        if (_mm256_movemask_epi8(valid) != -1)
+            break;
+
+        __m256i sextets = _mm256_and_si256(upper, _mm256_sub_epi8(c, _mm256_set1_epi8('A')));
+        sextets = _mm256_or_si256(sextets, _mm256_and_si256(lower, _mm256_sub_epi8(c, _mm256_set1_epi8('a' - 26))));
+        sextets = _mm256_or_si256(sextets, _mm256_and_si256(digit, _mm256_add_epi8(c, _mm256_set1_epi8(52 - '0'))));
+        sextets = _mm256_or_si256(sextets, _mm256_and_si256(plus, _mm256_set1_epi8(62)));
+        sextets = _mm256_or_si256(sextets, _mm256_and_si256(slash, _mm256_set1_epi8(63)));
+
+        const __m256i pairs = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(sextets, _mm256_set1_epi16(0x00ff)), 6),
+                                              _mm256_srli_epi16(sextets, 8));
+        const __m256i triples = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(pairs, _mm256_set1_epi32(0xffff)), 12),
+                                                _mm256_srli_epi32(pairs, 16));
+        const __m256i bytes = _mm256_shuffle_epi8(triples, compact);
+
+        // 12 valid bytes per lane; the second lane goes through memory so nothing is written past the output
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + o), _mm256_castsi256_si128(bytes));
+        uchar tail[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(tail), _mm256_extracti128_si256(bytes, 1));
+        memcpy(dst + o + 12, tail, 12);
+    }
+    return i;
+}
+
+#endif // NODEQML_CODECS_X86
+
+}
+
+size_t Codecs::utf8Length(const ushort *src, size_t length)
+{
+    size_t i = 0;
+#ifdef NODEQML_CODECS_X86
+    if (hasSse2())
+        i = asciiPrefixLength(src, length);
+#endif
+
+    size_t size = i;
+    for (; i < length; ++i) {
+        const ushort c = src[i];
+        if (c < 0x80) {
+            size += 1;
+        } else if (c < 0x800) {
+            size += 2;
+        } else if (c >= 0xd800 && c < 0xdc00 && i + 1 < length && src[i + 1] >= 0xdc00 && src[i + 1] < 0xe000) {
+            size += 4;
+            ++i;
+        } else {
+            size += 3;
+        }
+    }
+    return size;
+}
+
+size_t Codecs::utf8Encode(const ushort *src, size_t length, uchar *dst, size_t capacity)
+{
+    size_t i = 0;
+    size_t o = 0;
+#ifdef NODEQML_CODECS_X86
+    if (hasSse2())
+        i = o = asciiEncodeSse2(src, length, dst, capacity);
+#endif
+
+    for (; i < length; ++i) {
+        uint c = src[i];
+
+        if (c < 0x80) {
+            if (o + 1 > capacity)
+                break;
+            dst[o++] = c;
+
+            // Back onto the fast path after a non-ASCII character
+#ifdef NODEQML_CODECS_X86
+            if (i + 16 < length && o + 16 < capacity && hasSse2()) {
+                const size_t n = asciiEncodeSse2(src + i + 1, length - i - 1, dst + o, capacity - o);
+                i += n;
+                o += n;
+            }
+#endif
+            continue;
+        }
+
+        if (c < 0x800) {
+            if (o + 2 > capacity)
+                break;
+            dst[o++] = 0xc0 | (c >> 6);
+            dst[o++] = 0x80 | (c & 0x3f);
+            continue;
+        }
+
+        if (c >= 0xd800 && c < 0xdc00 && i + 1 < length && src[i + 1] >= 0xdc00 && src[i + 1] < 0xe000) {
+            if (o + 4 > capacity)
+                break;
+            c = 0x10000 + ((c - 0xd800) << 10) + (src[i + 1] - 0xdc00);
+            dst[o++] = 0xf0 | (c >> 18);
+            dst[o++] = 0x80 | ((c >> 12) & 0x3f);
+            dst[o++] = 0x80 | ((c >> 6) & 0x3f);
+            dst[o++] = 0x80 | (c & 0x3f);
+            ++i;
+            continue;
+        }
+
+        if (c >= 0xd800 && c < 0xe000)
+            c = 0xfffd;
+
+        if (o + 3 > capacity)
+            break;
+        dst[o++] = 0xe0 | (c >> 12);
+        dst[o++] = 0x80 | ((c >> 6) & 0x3f);
+        dst[o++] = 0x80 | (c & 0x3f);
+    }
+    return o;
+}
+
+void Codecs::latin1Encode(const ushort *src, size_t length, uchar *dst)
+{
+    size_t i = 0;
+#ifdef NODEQML_CODECS_X86
+    if (hasSse2())
+        i = latin1EncodeSse2(src, length, dst);
+#endif
+
+    for (; i < length; ++i)
+        dst[i] = src[i];
+}
+
+void Codecs::hexEncode(const uchar *src, size_t length, ushort *dst)
+{
+    size_t i = 0;
+#ifdef NODEQML_CODECS_X86
+    if (cpu().avx2)
+        i = hexEncodeAvx2(src, length, dst);
+    else if (hasSse2())
+        i = hexEncodeSse2(src, length, dst);
+#endif
+
+    for (; i < length; ++i) {
+        dst[i * 2] = hexDigits[src[i] >> 4];
+        dst[i * 2 + 1] = hexDigits[src[i] & 0x0f];
+    }
+}
+
+size_t Codecs::hexDecode(const ushort *src, size_t length, uchar *dst)
+{
+    size_t i = 0;
+#ifdef NODEQML_CODECS_X86
+    if (cpu().avx2)
+        i = hexDecodeAvx2(src, length, dst);
+    else if (hasSse2())
+        i = hexDecodeSse2(src, length, dst);
+#endif
+
+    for (; i + 1 < length; i += 2) {
+        const int hi = unhex(src[i]);
+        const int lo = unhex(src[i + 1]);
+        if (hi < 0 || lo < 0)
+            break;
+        dst[i / 2] = (hi << 4) | lo;
+    }
+    return i / 2;
+}
+
+void Codecs::base64Encode(const uchar *src, size_t length, ushort *dst)
+{
+    size_t i = 0;
+    size_t o = 0;
+#ifdef NODEQML_CODECS_X86
+    if (cpu().avx2)
+        i = base64EncodeAvx2(src, length, dst);
+    else if (cpu().ssse3)
+        i = base64EncodeSsse3(src, length, dst);
+    o = i / 3 * 4;
+#endif
+
+    for (; i + 3 <= length; i += 3, o += 4) {
+        const uint triple = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+        dst[o] = base64Chars[triple >> 18];
+        dst[o + 1] = base64Chars[(triple >> 12) & 0x3f];
+        dst[o + 2] = base64Chars[(triple >> 6) & 0x3f];
+        dst[o + 3] = base64Chars[triple & 0x3f];
+    }
+
+    if (i < length) {
+        const uint b0 = src[i];
+        const uint b1 = i + 1 < length ? src[i + 1] : 0;
+        dst[o] = base64Chars[b0 >> 2];
+        dst[o + 1] = base64Chars[((b0 & 0x03) << 4) | (b1 >> 4)];
+        dst[o + 2] = i + 1 < length ? base64Chars[(b1 & 0x0f) << 2] : '=';
+        dst[o + 3] = '=';
+    }
+}
+
+size_t Codecs::base64DecodedLength(const ushort *src, size_t length)
+{
+    if (length && src[length - 1] == '=')
+        --length;
+    if (length && src[length - 1] == '=')
+        --length;
+
+    const size_t remainder = length % 4;
+    size_t size = length / 4 * 3;
+    if (remainder > 1)
+        size += remainder - 1;
+    return size;
+}
+
+size_t Codecs::base64Decode(const ushort *src, size_t length, uchar *dst, size_t capacity)
+{
+    size_t i = 0;
+    size_t o = 0;
+#ifdef NODEQML_CODECS_X86
+    if (cpu().avx2)
+        i = base64DecodeAvx2(src, length, dst, capacity);
+    else if (hasSse2())
+        i = base64DecodeSse2(src, length, dst, capacity);
+    o = i / 4 * 3;
+#endif
+
+    // Same rules as node: characters outside the alphabet are skipped, '=' ends the input
+    uint bits = 0;
+    int count = 0;
+    for (; i < length && o < capacity; ++i) {
+        if (src[i] == '=')
+            break;
+
+        const int value = unbase64(src[i]);
+        if (value < 0)
+            continue;
+
+        bits = (bits << 6) | value;
+        if (++count == 4) {
+            const uchar group[3] = { uchar(bits >> 16), uchar(bits >> 8), uchar(bits) };
+            const size_t n = qMin<size_t>(3, capacity - o);
+            memcpy(dst + o, group, n);
+            o += n;
+            bits = 0;
+            count = 0;
+        }
+    }
+
+    // A trailing group of 2 or 3 characters carries 1 or 2 bytes
+    if (count > 1 && o < capacity)
+        dst[o++] = bits >> (count * 6 - 8);
+    if (count > 2 && o < capacity)
+        dst[o++] = bits >> 2;
+    return o;
+}
@@ -0,0 +1,48 @@
+#ifndef CODECS_H
+#define CODECS_H
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+namespace NodeQml {
+
+/// Transcoders between QString UTF-16 storage and raw buffer memory (UTF-8,
+/// Latin-1, hex and base64). On x86 the bulk of the data goes through
+/// SSE2/SSSE3 or AVX2 kernels picked once at runtime; the tails and non-x86
+/// builds use scalar code.
+namespace Codecs {
+
+/// Unpaired surrogates count as U+FFFD (3 bytes), as they are encoded.
+size_t utf8Length(const ushort *src, size_t length);
+
+/// Writes whole characters only, stopping before one that would exceed
+/// capacity. Returns the number of bytes written.
+size_t utf8Encode(const ushort *src, size_t length, uchar *dst, size_t capacity);
+
+/// Keeps the low byte of every code unit ("binary" / "ascii" in node).
+void latin1Encode(const ushort *src, size_t length, uchar *dst);
+
+inline size_t hexEncodedLength(size_t length) { return length * 2; }
+void hexEncode(const uchar *src, size_t length, ushort *dst);
+
+/// Decodes up to length / 2 bytes and stops at the first invalid pair, like
+/// node does. Returns the number of bytes written.
+size_t hexDecode(const ushort *src, size_t length, uchar *dst);
+
+inline size_t base64EncodedLength(size_t length) { return (length + 2) / 3 * 4; }
+void base64Encode(const uchar *src, size_t length, ushort *dst);
+
+/// Upper bound of the decoded size, exact for well-formed input.
+size_t base64DecodedLength(const ushort *src, size_t length);
+
+/// Accepts both the standard and the URL-safe alphabet, skips characters
+/// outside of them and stops at the first '=' or when capacity is reached.
+/// Returns the number of bytes written.
+size_t base64Decode(const ushort *src, size_t length, uchar *dst, size_t capacity);
+
+} // namespace Codecs
+
+} // namespace NodeQml
+
+#endif // CODECS_H
@@ -0,0 +1,168 @@
+#include "hdrhistogram.h"
+
+#include <qmath.h>
+
+using namespace NodeQml;
+
+namespace {
+
+inline int bitLength(qint64 value)
+{
+    return 64 - __builtin_clzll(value);
+}
+
+}
+
+HdrHistogram::HdrHistogram(qint64 highestTrackableValue, int significantFigures) :
+    m_highestTrackableValue(qMax<qint64>(highestTrackableValue, 2))
+{
+    significantFigures = qBound(1, significantFigures, 5);
+
+    qint64 largestValueWithSingleUnitResolution = 2;
+    for (int i = 0; i < significantFigures; ++i)
+        largestValueWithSingleUnitResolution *= 10;
+
+    const int subBucketCountMagnitude = bitLength(largestValueWithSingleUnitResolution - 1);
+    m_subBucketHalfCountMagnitude = qMax(subBucketCountMagnitude, 1) - 1;
+    m_subBucketCount = 1 << (m_subBucketHalfCountMagnitude + 1);
+    m_subBucketHalfCount = m_subBucketCount / 2;
+    m_subBucketMask = m_subBucketCount - 1;
+
+    // Number of power-of-two buckets needed to cover the whole range
+    qint64 smallestUntrackableValue = m_subBucketCount;
+    int bucketCount = 1;
+    while (smallestUntrackableValue <= m_highestTrackableValue) {
+        if (smallestUntrackableValue > Q_INT64_C(0x3fffffffffffffff)) {
+            ++bucketCount;
+            break;
+        }
+        smallestUntrackableValue <<= 1;
+        ++bucketCount;
+    }
+
+    m_counts.fill(0, (bucketCount + 1) * m_subBucketHalfCount);
+    reset();
+}
+
+void HdrHistogram::record(qint64 value)
+{
+    if (value < 1)
+        value = 1;
+
+    if (value > m_highestTrackableValue) {
+        ++m_exceeds;
+        return;
+    }
+
+    ++m_counts[countsIndex(value)];
+    ++m_totalCount;
+    m_min = qMin(m_min, value);
+    m_max = qMax(m_max, value);
+}
+
+void HdrHistogram::reset()
+{
+    m_counts.fill(0);
+    m_totalCount = 0;
+    m_exceeds = 0;
+    m_min = Q_INT64_C(0x7fffffffffffffff);
+    m_max = 0;
+}
+
+qint64 HdrHistogram::min() const
+{
+    return m_totalCount ? m_min : 0;
+}
+
+qint64 HdrHistogram::max() const
+{
+    return m_totalCount ? highestEquivalentValue(m_max) : 0;
+}
+
+double HdrHistogram::mean() const
+{
+    if (!m_totalCount)
+        return 0;
+
+    double total = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        if (m_counts.at(i))
+            total += m_counts.at(i) * double(medianEquivalentValue(valueFromIndex(i)));
+    }
+    return total / m_totalCount;
+}
+
+double HdrHistogram::stddev() const
+{
+    if (!m_totalCount)
+        return 0;
+
+    const double average = mean();
+    double geometricDeviationTotal = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        if (!m_counts.at(i))
+            continue;
+        const double deviation = medianEquivalentValue(valueFromIndex(i)) - average;
+        geometricDeviationTotal += deviation * deviation * m_counts.at(i);
+    }
+    return qSqrt(geometricDeviationTotal / m_totalCount);
+}
+
+qint64 HdrHistogram::valueAtPercentile(double percentile) const
+{
+    if (!m_totalCount)
+        return 0;
+
+    percentile = qBound(0.0, percentile, 100.0);
+    const qint64 countAtPercentile
+            = qMax<qint64>(1, qint64(percentile / 100 * m_totalCount + 0.5));
+
+    qint64 total = 0;
+    for (int i = 0; i < m_counts.size(); ++i) {
+        total += m_counts.at(i);
+        if (total >= countAtPercentile)
+            return highestEquivalentValue(valueFromIndex(i));
+    }
+    return 0;
+}
+
+int HdrHistogram::bucketIndex(qint64 value) const
+{
+    return bitLength(value | m_subBucketMask) - (m_subBucketHalfCountMagnitude + 1);
+}
+
+int HdrHistogram::countsIndex(qint64 value) const
+{
+    const int bucket = bucketIndex(value);
+    const int subBucket = int(value >> bucket);
+    return ((bucket + 1) << m_subBucketHalfCountMagnitude) + (subBucket - m_subBucketHalfCount);
+}
+
+qint64 HdrHistogram::valueFromIndex(int index) const
+{
+    int bucket = (index >> m_subBucketHalfCountMagnitude) - 1;
+    int subBucket = (index & (m_subBucketHalfCount - 1)) + m_subBucketHalfCount;
+    if (bucket < 0) {
+        subBucket -= m_subBucketHalfCount;
+        bucket = 0;
+    }
+    return qint64(subBucket) << bucket;
+}
+
+qint64 HdrHistogram::highestEquivalentValue(qint64 value) const
+{
+    const int bucket = bucketIndex(value);
+    const int subBucket = int(value >> bucket);
+    const qint64 lowest = qint64(subBucket) << bucket;
+    const int adjustedBucket = subBucket >= m_subBucketCount ? bucket + 1 : bucket;
+    return lowest + (Q_INT64_C(1) << adjustedBucket) - 1;
+}
+
+qint64 HdrHistogram::medianEquivalentValue(qint64 value) const
+{
+    const int bucket = bucketIndex(value);
+    const int subBucket = int(value >> bucket);
+    const qint64 lowest = qint64(subBucket) << bucket;
+    const int adjustedBucket = subBucket >= m_subBucketCount ? bucket + 1 : bucket;
+    return lowest + ((Q_INT64_C(1) << adjustedBucket) >> 1);
+}
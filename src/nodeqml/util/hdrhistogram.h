@@ -0,0 +1,50 @@
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include <QVector>
+
+namespace NodeQml {
+
+/// High Dynamic Range histogram of positive integer values (lowest trackable
+/// value is 1) with a fixed number of significant decimal digits. Recording is
+/// O(1) and does not allocate; memory is sized once from the value range.
+class HdrHistogram
+{
+public:
+    explicit HdrHistogram(qint64 highestTrackableValue = Q_INT64_C(3600000000000),
+                          int significantFigures = 3);
+
+    void record(qint64 value);
+    void reset();
+
+    qint64 count() const { return m_totalCount; }
+    qint64 exceeds() const { return m_exceeds; }
+    qint64 min() const;
+    qint64 max() const;
+    double mean() const;
+    double stddev() const;
+    qint64 valueAtPercentile(double percentile) const;
+
+private:
+    int bucketIndex(qint64 value) const;
+    int countsIndex(qint64 value) const;
+    qint64 valueFromIndex(int index) const;
+    qint64 highestEquivalentValue(qint64 value) const;
+    qint64 medianEquivalentValue(qint64 value) const;
+
+    qint64 m_highestTrackableValue;
+    int m_subBucketHalfCountMagnitude;
+    int m_subBucketHalfCount;
+    qint64 m_subBucketMask;
+    int m_subBucketCount;
+
+    QVector<qint64> m_counts;
+    qint64 m_totalCount = 0;
+    qint64 m_exceeds = 0;
+    qint64 m_min;
+    qint64 m_max;
+};
+
+} // namespace NodeQml
+
+#endif // HDRHISTOGRAM_H
@@ -0,0 +1,285 @@
+#include "packageindex.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace NodeQml;
+
+namespace {
+
+const int ManifestVersion = 2;
+
+// One file per root under the cache directory, named after its absolute path
+QString manifestPath(const QString &nodeModulesPath)
+{
+    const QByteArray key = QCryptographicHash::hash(QDir(nodeModulesPath).absolutePath().toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QStringLiteral("/package-index/") + QString::fromLatin1(key) + QStringLiteral(".json");
+}
+
+// -1 if the path does not exist
+inline qint64 modificationTime(const QString &path)
+{
+    const QFileInfo fi(path);
+    return fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+inline QString packageJsonPath(const QString &directory)
+{
+    return directory + QStringLiteral("/package.json");
+}
+
+QString packageMain(const QString &directory)
+{
+    QFile file(packageJsonPath(directory));
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    const QJsonDocument json = QJsonDocument::fromJson(file.readAll());
+    return json.object().value(QStringLiteral("main")).toString();
+}
+
+}
+
+PackageIndex::PackageIndex()
+{
+
+}
+
+bool PackageIndex::isBareSpecifier(const QString &request)
+{
+    if (request.isEmpty() || QDir::isAbsolutePath(request))
+        return false;
+
+    return request != QStringLiteral(".") && request != QStringLiteral("..")
+            && !request.startsWith(QStringLiteral("./")) && !request.startsWith(QStringLiteral("../"));
+}
+
+QString PackageIndex::resolvePath(const QString &path)
+{
+    QFileInfo fi(path);
+    if (fi.isFile())
+        return fi.absoluteFilePath();
+
+    if (!fi.exists()) {
+        fi.setFile(path + QStringLiteral(".js"));
+        return fi.isFile() ? fi.absoluteFilePath() : QString();
+    }
+
+    return resolveDirectory(fi.absoluteFilePath());
+}
+
+QString PackageIndex::resolveDirectory(const QString &path)
+{
+    const QString main = packageMain(path);
+    if (!main.isEmpty()) {
+        const QString mainPath = QDir::cleanPath(path + QLatin1Char('/') + main);
+        QFileInfo fi(mainPath);
+        if (fi.isFile())
+            return fi.absoluteFilePath();
+
+        fi.setFile(mainPath + QStringLiteral(".js"));
+        if (fi.isFile())
+            return fi.absoluteFilePath();
+
+        fi.setFile(mainPath + QStringLiteral("/index.js"));
+        if (fi.isFile())
+            return fi.absoluteFilePath();
+    }
+
+    /// TODO: index.[ext]
+    QFileInfo indexInfo(path + QStringLiteral("/index.js"));
+    if (indexInfo.isFile())
+        return indexInfo.absoluteFilePath();
+
+    return QString();
+}
+
+QString PackageIndex::resolve(const QString &request, const QString &fromPath)
+{
+    // "@scope/name/sub" -> "@scope/name" + "sub"
+    int nameLength = request.indexOf(QLatin1Char('/'));
+    if (request.startsWith(QLatin1Char('@')) && nameLength >= 0)
+        nameLength = request.indexOf(QLatin1Char('/'), nameLength + 1);
+
+    const QString name = nameLength < 0 ? request : request.left(nameLength);
+    const QString subPath = nameLength < 0 ? QString() : request.mid(nameLength + 1);
+
+    QDir dir(fromPath.isEmpty() ? QDir::currentPath() : fromPath);
+    do {
+        if (dir.dirName() == QStringLiteral("node_modules"))
+            continue;
+
+        const Package *p = package(dir.absoluteFilePath(QStringLiteral("node_modules")), name);
+        if (!p)
+            continue;
+
+        if (subPath.isEmpty()) {
+            if (!p->main.isEmpty())
+                return p->main;
+        } else {
+            const QString filename = resolvePath(p->directory + QLatin1Char('/') + subPath);
+            if (!filename.isEmpty())
+                return filename;
+        }
+    } while (dir.cdUp());
+
+    return QString();
+}
+
+const PackageIndex::Package *PackageIndex::package(const QString &nodeModulesPath, const QString &name)
+{
+    const Root &packages = root(nodeModulesPath);
+    Root::const_iterator it = packages.constFind(name);
+    return it == packages.constEnd() ? nullptr : &it.value();
+}
+
+void PackageIndex::clear()
+{
+    m_roots.clear();
+}
+
+const PackageIndex::Root &PackageIndex::root(const QString &nodeModulesPath)
+{
+    QHash<QString, Root>::iterator it = m_roots.find(nodeModulesPath);
+    if (it != m_roots.end())
+        return it.value();
+
+    // Missing roots are kept as empty entries so they are only stat'ed once
+    Root &packages = m_roots[nodeModulesPath];
+    if (!QFileInfo(nodeModulesPath).isDir())
+        return packages;
+
+    bool changed = false;
+    if (m_persistent && loadManifest(nodeModulesPath, &packages, &changed)) {
+        if (changed)
+            saveManifest(nodeModulesPath, packages);
+        return packages;
+    }
+
+    scan(nodeModulesPath, &packages);
+    if (m_persistent)
+        saveManifest(nodeModulesPath, packages);
+
+    return packages;
+}
+
+void PackageIndex::scan(const QString &nodeModulesPath, Root *root) const
+{
+    const QDir::Filters filters = QDir::Dirs | QDir::NoDotAndDotDot;
+
+    QDir dir(nodeModulesPath);
+    foreach (const QString &entry, dir.entryList(filters)) {
+        if (entry.startsWith(QLatin1Char('.')))
+            continue;
+
+        if (!entry.startsWith(QLatin1Char('@'))) {
+            addPackage(entry, dir.absoluteFilePath(entry), root);
+            continue;
+        }
+
+        QDir scope(dir.absoluteFilePath(entry));
+        foreach (const QString &scoped, scope.entryList(filters))
+            addPackage(entry + QLatin1Char('/') + scoped, scope.absoluteFilePath(scoped), root);
+    }
+}
+
+void PackageIndex::addPackage(const QString &name, const QString &directory, Root *root) const
+{
+    Package p;
+    p.directory = directory;
+    p.main = resolveDirectory(directory);
+    root->insert(name, p);
+}
+
+bool PackageIndex::loadManifest(const QString &nodeModulesPath, Root *root, bool *changed) const
+{
+    QFile file(manifestPath(nodeModulesPath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    if (manifest.value(QStringLiteral("version")).toInt() != ManifestVersion)
+        return false;
+
+    // Installing or removing a package touches node_modules or its @scope directory
+    const QDir dir(nodeModulesPath);
+    if (manifest.value(QStringLiteral("root")).toString() != dir.absolutePath())
+        return false;
+
+    const QJsonObject mtimes = manifest.value(QStringLiteral("mtimes")).toObject();
+    for (QJsonObject::const_iterator it = mtimes.constBegin(); it != mtimes.constEnd(); ++it) {
+        if (modificationTime(dir.absoluteFilePath(it.key())) != qint64(it.value().toDouble()))
+            return false;
+    }
+
+    // Editing package.json or removing the main file in place leaves the directories alone
+    const QJsonObject packages = manifest.value(QStringLiteral("packages")).toObject();
+    for (QJsonObject::const_iterator it = packages.constBegin(); it != packages.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        const QString directory = dir.absoluteFilePath(it.key());
+        const QString main = entry.value(QStringLiteral("main")).toString();
+
+        if (modificationTime(packageJsonPath(directory)) != qint64(entry.value(QStringLiteral("mtime")).toDouble())
+                || (!main.isEmpty() && !QFileInfo(dir.absoluteFilePath(main)).isFile())) {
+            addPackage(it.key(), directory, root);
+            *changed = true;
+            continue;
+        }
+
+        Package p;
+        p.directory = directory;
+        if (!main.isEmpty())
+            p.main = QDir::cleanPath(dir.absoluteFilePath(main));
+        root->insert(it.key(), p);
+    }
+
+    return true;
+}
+
+void PackageIndex::saveManifest(const QString &nodeModulesPath, const Root &root) const
+{
+    // Paths are stored relative to node_modules so the tree can be moved
+    const QDir dir(nodeModulesPath);
+    QJsonObject mtimes;
+    QJsonObject packages;
+
+    mtimes.insert(QStringLiteral("."), double(modificationTime(nodeModulesPath)));
+    for (Root::const_iterator it = root.constBegin(); it != root.constEnd(); ++it) {
+        QJsonObject entry;
+        entry.insert(QStringLiteral("main"), it->main.isEmpty() ? QString() : dir.relativeFilePath(it->main));
+        entry.insert(QStringLiteral("mtime"), double(modificationTime(packageJsonPath(it->directory))));
+        packages.insert(it.key(), entry);
+
+        if (it.key().startsWith(QLatin1Char('@'))) {
+            const QString scope = it.key().section(QLatin1Char('/'), 0, 0);
+            if (!mtimes.contains(scope))
+                mtimes.insert(scope, double(modificationTime(dir.absoluteFilePath(scope))));
+        }
+    }
+
+    QJsonObject manifest;
+    manifest.insert(QStringLiteral("version"), ManifestVersion);
+    manifest.insert(QStringLiteral("root"), dir.absolutePath());
+    manifest.insert(QStringLiteral("mtimes"), mtimes);
+    manifest.insert(QStringLiteral("packages"), packages);
+
+    const QString path = manifestPath(nodeModulesPath);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact));
+    file.commit();
+}
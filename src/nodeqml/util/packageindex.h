@@ -0,0 +1,61 @@
+#ifndef PACKAGEINDEX_H
+#define PACKAGEINDEX_H
+
+#include <QHash>
+#include <QString>
+
+namespace NodeQml {
+
+/// Index of the packages installed in node_modules directories. Each
+/// node_modules root is scanned once (top-level and @scope directories) and
+/// the entry point of every package is resolved up front, so looking up a
+/// bare specifier is a hash lookup per ancestor directory.
+///
+/// With persistence enabled, the index of a root is written to the user's
+/// cache directory and reused while neither node_modules nor its @scope
+/// directories are modified. Packages whose package.json changed, or whose
+/// main file disappeared, are resolved again.
+class PackageIndex
+{
+public:
+    struct Package {
+        QString directory;
+        QString main; // empty if the package has no resolvable entry point
+    };
+
+    PackageIndex();
+
+    void setPersistent(bool persistent) { m_persistent = persistent; }
+    bool isPersistent() const { return m_persistent; }
+
+    /// Resolves a bare specifier ("name" or "name/sub/path") from a directory.
+    QString resolve(const QString &request, const QString &fromPath);
+    const Package *package(const QString &nodeModulesPath, const QString &name);
+
+    void clear();
+
+    /// Resolves a file or directory path the way require() does (path, path.js,
+    /// package.json main, index.js).
+    static QString resolvePath(const QString &path);
+    static QString resolveDirectory(const QString &path);
+
+    static bool isBareSpecifier(const QString &request);
+
+private:
+    Q_DISABLE_COPY(PackageIndex)
+
+    typedef QHash<QString, Package> Root;
+
+    const Root &root(const QString &nodeModulesPath);
+    void scan(const QString &nodeModulesPath, Root *root) const;
+    void addPackage(const QString &name, const QString &directory, Root *root) const;
+    bool loadManifest(const QString &nodeModulesPath, Root *root, bool *changed) const;
+    void saveManifest(const QString &nodeModulesPath, const Root &root) const;
+
+    QHash<QString, Root> m_roots;
+    bool m_persistent = false;
+};
+
+} // namespace NodeQml
+
+#endif // PACKAGEINDEX_H
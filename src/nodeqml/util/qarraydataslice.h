@@ -5,61 +5,140 @@
 #include <QTypeInfo>
 #include <QtAlgorithms>
 
-/// TODO: Clean, refactor and optimise
+#include <cstring>
+#include <limits>
+#include <utility>
 
+/// Header for memory owned by someone else, e.g. a mapped file. Qt never sets
+/// capacityReserved on data with alloc == 0, so that combination marks it; the
+/// cleanup function runs in place of deallocation once the last slice is gone.
+/// Unlike QArrayData::size, length is not limited to 2 GB.
+struct QExternalArrayData : QArrayData
+{
+    typedef void (*CleanupFunction)(void *data, void *info);
+
+    CleanupFunction cleanupFunction;
+    void *cleanupInfo;
+    size_t length;
+
+    static bool isExternal(const QArrayData *d) { return !d->alloc && d->capacityReserved; }
+
+    static size_t lengthOf(const QArrayData *d)
+    {
+        return isExternal(d) ? static_cast<const QExternalArrayData *>(d)->length : size_t(d->size);
+    }
+
+    template<typename T>
+    static QTypedArrayData<T> *create(T *data, size_t length, CleanupFunction cleanupFunction, void *cleanupInfo)
+    {
+        QExternalArrayData *d = new QExternalArrayData;
+        d->ref.atomic.store(1);
+        d->size = int(qMin<size_t>(length, std::numeric_limits<int>::max()));
+        d->length = length;
+        d->alloc = 0;
+        d->capacityReserved = 1;
+        d->offset = reinterpret_cast<char *>(data) - reinterpret_cast<char *>(d);
+        d->cleanupFunction = cleanupFunction;
+        d->cleanupInfo = cleanupInfo;
+        return static_cast<QTypedArrayData<T> *>(static_cast<QArrayData *>(d));
+    }
+
+    static void release(QArrayData *d)
+    {
+        QExternalArrayData *external = static_cast<QExternalArrayData *>(d);
+        if (external->cleanupFunction)
+            external->cleanupFunction(external->data(), external->cleanupInfo);
+        delete external;
+    }
+};
+
+/// Refcounted view of [offset, offset + size) in a QTypedArrayData. Sizes are
+/// size_t, so views of external data may exceed 2 GB. Moving a slice hands
+/// its reference over and costs no atomic operation.
 template<typename T>
 class QTypedArrayDataSlice
 {
 public:
     QTypedArrayDataSlice() {}
-    QTypedArrayDataSlice(QTypedArrayData<T> *arrayData, int offset = 0, int size = -1);
-    QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &slice, int offset = 0, int size = -1);
+    explicit QTypedArrayDataSlice(QTypedArrayData<T> *arrayData);
+    QTypedArrayDataSlice(QTypedArrayData<T> *arrayData, size_t offset, size_t size);
+    QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &slice, size_t offset, size_t size);
+    QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &other);
+    QTypedArrayDataSlice(QTypedArrayDataSlice<T> &&other) Q_DECL_NOTHROW;
     ~QTypedArrayDataSlice();
 
-    QTypedArrayDataSlice &operator=(const QTypedArrayDataSlice&);
+    QTypedArrayDataSlice &operator=(const QTypedArrayDataSlice<T> &other);
+    QTypedArrayDataSlice &operator=(QTypedArrayDataSlice<T> &&other) Q_DECL_NOTHROW;
+    void swap(QTypedArrayDataSlice<T> &other) Q_DECL_NOTHROW;
 
     bool isEmpty() const { return !m_size; }
     bool isNull() const { return !m_arrayData; }
 
-    int size() const { return m_size; }
+    size_t size() const { return m_size; }
 
     inline T *data();
     inline const T *constData() const;
 
-    const T &at(int i) const;
-    T &operator[](int i);
-    const T &operator[](int i) const;
+    const T &at(size_t i) const;
+    T &operator[](size_t i);
+    const T &operator[](size_t i) const;
 
     void clearData();
-    void setData(QTypedArrayData<T> *arrayData, int offset = 0, int size = -1);
+    void setData(QTypedArrayData<T> *arrayData);
+    void setData(QTypedArrayData<T> *arrayData, size_t offset, size_t size);
 
 private:
+    void assign(QTypedArrayData<T> *arrayData, T *begin, size_t size);
+
     QTypedArrayData<T> *m_arrayData = nullptr;
     T *m_begin = nullptr;
-    int m_size = 0;
+    size_t m_size = 0;
 };
 
 template<typename T>
 inline bool operator == (const QTypedArrayDataSlice<T> &a, const QTypedArrayDataSlice<T> &b)
 {
-    return a.size() == b.size() && !memcmp(a.data(), b.data(), a.size());
+    return a.size() == b.size() && (!a.size() || !memcmp(a.constData(), b.constData(), a.size() * sizeof(T)));
 }
 
 template<typename T>
-QTypedArrayDataSlice<T>::QTypedArrayDataSlice(QTypedArrayData<T> *arrayData, int offset, int size)
+QTypedArrayDataSlice<T>::QTypedArrayDataSlice(QTypedArrayData<T> *arrayData)
 {
-    if (!arrayData)
-        return;
-    setData(arrayData, offset, size);
+    if (arrayData)
+        setData(arrayData);
+}
+
+template<typename T>
+QTypedArrayDataSlice<T>::QTypedArrayDataSlice(QTypedArrayData<T> *arrayData, size_t offset, size_t size)
+{
+    if (arrayData)
+        setData(arrayData, offset, size);
+}
+
+template<typename T>
+QTypedArrayDataSlice<T>::QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &slice, size_t offset, size_t size)
+{
+    Q_ASSERT_X(offset + size <= slice.m_size, "QTypedArrayDataSlice<T>::QTypedArrayDataSlice", "range out of slice");
+    if (size)
+        assign(slice.m_arrayData, slice.m_begin + offset, size);
 }
 
 template<typename T>
-QTypedArrayDataSlice<T>::QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &slice, int offset, int size)
+QTypedArrayDataSlice<T>::QTypedArrayDataSlice(const QTypedArrayDataSlice<T> &other)
 {
-    offset += slice.m_begin - slice.m_arrayData->data();
-    if (size == -1)
-        size = slice.m_size;
-    setData(slice.m_arrayData, offset, size);
+    if (other.m_arrayData)
+        assign(other.m_arrayData, other.m_begin, other.m_size);
+}
+
+template<typename T>
+QTypedArrayDataSlice<T>::QTypedArrayDataSlice(QTypedArrayDataSlice<T> &&other) Q_DECL_NOTHROW :
+    m_arrayData(other.m_arrayData),
+    m_begin(other.m_begin),
+    m_size(other.m_size)
+{
+    other.m_arrayData = nullptr;
+    other.m_begin = nullptr;
+    other.m_size = 0;
 }
 
 template<typename T>
@@ -69,43 +148,59 @@ QTypedArrayDataSlice<T>::~QTypedArrayDataSlice()
 }
 
 template<typename T>
-QTypedArrayDataSlice<T> &QTypedArrayDataSlice<T>::operator=(const QTypedArrayDataSlice &other)
+QTypedArrayDataSlice<T> &QTypedArrayDataSlice<T>::operator=(const QTypedArrayDataSlice<T> &other)
+{
+    QTypedArrayDataSlice<T> copy(other);
+    swap(copy);
+    return *this;
+}
+
+template<typename T>
+QTypedArrayDataSlice<T> &QTypedArrayDataSlice<T>::operator=(QTypedArrayDataSlice<T> &&other) Q_DECL_NOTHROW
 {
-    const int offset = other.m_begin - other.m_arrayData->data();
-    setData(other.m_arrayData, offset, other.m_size);
+    QTypedArrayDataSlice<T> moved(std::move(other));
+    swap(moved);
     return *this;
 }
 
+template<typename T>
+void QTypedArrayDataSlice<T>::swap(QTypedArrayDataSlice<T> &other) Q_DECL_NOTHROW
+{
+    qSwap(m_arrayData, other.m_arrayData);
+    qSwap(m_begin, other.m_begin);
+    qSwap(m_size, other.m_size);
+}
+
 template<typename T>
 T *QTypedArrayDataSlice<T>::data()
 {
-    return static_cast<T *>(m_begin);
+    return m_begin;
 }
 
 template<typename T>
 const T *QTypedArrayDataSlice<T>::constData() const
 {
-    return static_cast<const T *>(m_begin);
+    return m_begin;
 }
 
 template<typename T>
-inline const T &QTypedArrayDataSlice<T>::at(int i) const
+inline const T &QTypedArrayDataSlice<T>::at(size_t i) const
 {
-    Q_ASSERT_X(i >= 0 && i < size(), "QTypedArrayDataSlice<T>::at", "index out of range");
+    Q_ASSERT_X(i < size(), "QTypedArrayDataSlice<T>::at", "index out of range");
     return constData()[i];
 }
 
 template<typename T>
-T &QTypedArrayDataSlice<T>::operator[](int i)
+T &QTypedArrayDataSlice<T>::operator[](size_t i)
 {
-    Q_ASSERT_X(i >= 0 && i < size(), "QTypedArrayDataSlice<T>::operator[]", "index out of range");
+    Q_ASSERT_X(i < size(), "QTypedArrayDataSlice<T>::operator[]", "index out of range");
     return data()[i];
 }
 
 template<typename T>
-const T &QTypedArrayDataSlice<T>::operator[](int i) const
+const T &QTypedArrayDataSlice<T>::operator[](size_t i) const
 {
-    Q_ASSERT_X(i >= 0 && i < size(), "QTypedArrayDataSlice<T>::operator[]", "index out of range");
+    Q_ASSERT_X(i < size(), "QTypedArrayDataSlice<T>::operator[]", "index out of range");
     return constData()[i];
 }
 
@@ -117,10 +212,13 @@ void QTypedArrayDataSlice<T>::clearData()
 
     if (!m_arrayData->ref.deref()) {
         if (QTypeInfo<T>::isComplex) {
-            for (int i = 0; i < size() ; ++i)
+            for (size_t i = 0; i < size() ; ++i)
                 at(i).~T();
         }
-        QTypedArrayData<T>::deallocate(m_arrayData);
+        if (QExternalArrayData::isExternal(m_arrayData))
+            QExternalArrayData::release(m_arrayData);
+        else
+            QTypedArrayData<T>::deallocate(m_arrayData);
     }
     m_arrayData = nullptr;
     m_begin = nullptr;
@@ -128,19 +226,31 @@ void QTypedArrayDataSlice<T>::clearData()
 }
 
 template<typename T>
-void QTypedArrayDataSlice<T>::setData(QTypedArrayData<T> *arrayData, int offset, int size)
+void QTypedArrayDataSlice<T>::setData(QTypedArrayData<T> *arrayData)
+{
+    Q_ASSERT(arrayData);
+    assign(arrayData, arrayData->data(), QExternalArrayData::lengthOf(arrayData));
+}
+
+template<typename T>
+void QTypedArrayDataSlice<T>::setData(QTypedArrayData<T> *arrayData, size_t offset, size_t size)
 {
     Q_ASSERT(arrayData);
-    Q_ASSERT_X(offset >= 0 && offset < arrayData->size,
-               "QTypedArrayDataSlice<T>::setData", "offset out of range");
-    Q_ASSERT_X(size == -1 || (size > 0 && offset + size <= arrayData->size),
-               "QTypedArrayDataSlice<T>::setData", "size out of range");
+    Q_ASSERT_X(size > 0 && offset + size <= QExternalArrayData::lengthOf(arrayData),
+               "QTypedArrayDataSlice<T>::setData", "range out of data");
+    assign(arrayData, arrayData->data() + offset, size);
+}
+
+// References the new data before releasing the old, so that reassigning a
+// slice of the same data is safe
+template<typename T>
+void QTypedArrayDataSlice<T>::assign(QTypedArrayData<T> *arrayData, T *begin, size_t size)
+{
+    arrayData->ref.ref();
     clearData();
-    if (arrayData)
-        arrayData->ref.ref();
     m_arrayData = arrayData;
-    m_begin = m_arrayData->data() + offset;
-    m_size = size == -1 ? arrayData->size : size;
+    m_begin = begin;
+    m_size = size;
 }
 
 #endif // QARRAYDATASLICE_H
@@ -0,0 +1,220 @@
+#include "timerwheel.h"
+
+using namespace NodeQml;
+
+namespace {
+
+inline quint64 rotl(quint64 v, int c)
+{
+    return c ? (v << c) | (v >> (64 - c)) : v;
+}
+
+inline quint64 rotr(quint64 v, int c)
+{
+    return c ? (v >> c) | (v << (64 - c)) : v;
+}
+
+inline int fls(quint64 v)
+{
+    return 64 - __builtin_clzll(v);
+}
+
+inline int ctz(quint64 v)
+{
+    return __builtin_ctzll(v);
+}
+
+}
+
+TimerWheel::TimerWheel()
+{
+    for (int level = 0; level < LevelCount; ++level) {
+        for (int slot = 0; slot < SlotCount; ++slot)
+            m_slots[level][slot].prev = m_slots[level][slot].next = &m_slots[level][slot];
+        m_pending[level] = 0;
+    }
+    m_expired.prev = m_expired.next = &m_expired;
+}
+
+TimerWheel::~TimerWheel()
+{
+    clear();
+}
+
+bool TimerWheel::isEmpty() const
+{
+    if (m_expired.next != &m_expired)
+        return false;
+
+    for (int level = 0; level < LevelCount; ++level) {
+        if (m_pending[level])
+            return false;
+    }
+    return true;
+}
+
+void TimerWheel::schedule(Node *node, qint64 expires)
+{
+    cancel(node);
+    node->expires = expires;
+
+    if (expires <= m_currentTime) {
+        append(&m_expired, node);
+        return;
+    }
+
+    const quint64 remaining = qMin<quint64>(expires - m_currentTime,
+                                            (Q_UINT64_C(1) << (SlotBits * LevelCount)) - 1);
+    const int level = (fls(remaining) - 1) / SlotBits;
+    const int slot = SlotMask & ((expires >> (level * SlotBits)) - !!level);
+
+    append(&m_slots[level][slot], node);
+    m_pending[level] |= Q_UINT64_C(1) << slot;
+}
+
+void TimerWheel::cancel(Node *node)
+{
+    if (!node->isPending())
+        return;
+
+    Node *list = node->list;
+    unlink(node);
+
+    if (list != &m_expired && list->next == list) {
+        const int index = list - &m_slots[0][0];
+        m_pending[index / SlotCount] &= ~(Q_UINT64_C(1) << (index % SlotCount));
+    }
+}
+
+void TimerWheel::clear()
+{
+    Node todo;
+    todo.prev = todo.next = &todo;
+
+    for (int level = 0; level < LevelCount; ++level) {
+        for (int slot = 0; slot < SlotCount; ++slot)
+            splice(&todo, &m_slots[level][slot]);
+        m_pending[level] = 0;
+    }
+    splice(&todo, &m_expired);
+
+    while (todo.next != &todo)
+        unlink(todo.next);
+}
+
+void TimerWheel::update(qint64 currentTime)
+{
+    if (currentTime <= m_currentTime)
+        return;
+
+    Node todo;
+    todo.prev = todo.next = &todo;
+
+    quint64 elapsed = currentTime - m_currentTime;
+
+    for (int level = 0; level < LevelCount; ++level) {
+        const int shift = level * SlotBits;
+        quint64 pending;
+
+        if ((elapsed >> shift) > SlotMask) {
+            pending = ~Q_UINT64_C(0);
+        } else {
+            const int elapsedSlots = SlotMask & (elapsed >> shift);
+            const int oldSlot = SlotMask & (m_currentTime >> shift);
+            const int newSlot = SlotMask & (currentTime >> shift);
+            const quint64 mask = (Q_UINT64_C(1) << elapsedSlots) - 1;
+
+            pending = rotl(mask, oldSlot);
+            pending |= rotr(rotl(mask, newSlot), elapsedSlots);
+            pending |= Q_UINT64_C(1) << newSlot;
+        }
+
+        while (pending & m_pending[level]) {
+            const int slot = ctz(pending & m_pending[level]);
+            splice(&todo, &m_slots[level][slot]);
+            m_pending[level] &= ~(Q_UINT64_C(1) << slot);
+        }
+
+        // Higher levels only need to be visited if this one wrapped around
+        if (!(pending & 1))
+            break;
+
+        elapsed = qMax<quint64>(elapsed, quint64(SlotCount) << shift);
+    }
+
+    m_currentTime = currentTime;
+
+    // Cascade: timers either expire or move down to a finer level
+    while (todo.next != &todo) {
+        Node *node = todo.next;
+        unlink(node);
+        schedule(node, node->expires);
+    }
+}
+
+TimerWheel::Node *TimerWheel::takeExpired()
+{
+    if (m_expired.next == &m_expired)
+        return nullptr;
+
+    Node *node = m_expired.next;
+    unlink(node);
+    return node;
+}
+
+qint64 TimerWheel::nextExpiry() const
+{
+    if (m_expired.next != &m_expired)
+        return m_currentTime;
+
+    quint64 timeout = ~Q_UINT64_C(0);
+    quint64 relativeMask = 0;
+
+    for (int level = 0; level < LevelCount; ++level) {
+        if (m_pending[level]) {
+            const int shift = level * SlotBits;
+            const int slot = SlotMask & (m_currentTime >> shift);
+            // Timers on higher levels are at least one rotation in the future
+            quint64 t = quint64(ctz(rotr(m_pending[level], slot)) + !!level) << shift;
+            t -= relativeMask & m_currentTime;
+            timeout = qMin(timeout, t);
+        }
+        relativeMask = (relativeMask << SlotBits) | SlotMask;
+    }
+
+    if (timeout == ~Q_UINT64_C(0))
+        return -1;
+    return m_currentTime + timeout;
+}
+
+void TimerWheel::append(Node *list, Node *node)
+{
+    node->list = list;
+    node->next = list;
+    node->prev = list->prev;
+    list->prev->next = node;
+    list->prev = node;
+}
+
+void TimerWheel::unlink(Node *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = nullptr;
+    node->list = nullptr;
+}
+
+void TimerWheel::splice(Node *to, Node *from)
+{
+    if (from->next == from)
+        return;
+
+    for (Node *node = from->next; node != from; node = node->next)
+        node->list = to;
+
+    from->next->prev = to->prev;
+    to->prev->next = from->next;
+    from->prev->next = to;
+    to->prev = from->prev;
+    from->prev = from->next = from;
+}
@@ -0,0 +1,61 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QtGlobal>
+
+namespace NodeQml {
+
+/// Hierarchical timing wheel (6 levels of 64 slots, millisecond ticks).
+/// Scheduling and cancellation are O(1); all timers expired since the previous
+/// update are collected in a single pass. Based on William Ahern's timeout.c.
+class TimerWheel
+{
+public:
+    struct Node {
+        Node *prev = nullptr;
+        Node *next = nullptr;
+        Node *list = nullptr;
+        qint64 expires = 0;
+
+        bool isPending() const { return list; }
+    };
+
+    TimerWheel();
+    ~TimerWheel();
+
+    qint64 currentTime() const { return m_currentTime; }
+    bool isEmpty() const;
+
+    void schedule(Node *node, qint64 expires);
+    void cancel(Node *node);
+    void clear();
+
+    void update(qint64 currentTime);
+    Node *takeExpired();
+
+    /// Lower bound of the next expiry time, or -1 if nothing is scheduled.
+    qint64 nextExpiry() const;
+
+private:
+    Q_DISABLE_COPY(TimerWheel)
+
+    enum {
+        SlotBits = 6,
+        SlotCount = 1 << SlotBits,
+        SlotMask = SlotCount - 1,
+        LevelCount = 6
+    };
+
+    static void append(Node *list, Node *node);
+    static void unlink(Node *node);
+    static void splice(Node *to, Node *from);
+
+    Node m_slots[LevelCount][SlotCount];
+    quint64 m_pending[LevelCount];
+    Node m_expired;
+    qint64 m_currentTime = 0;
+};
+
+} // namespace NodeQml
+
+#endif // TIMERWHEEL_H
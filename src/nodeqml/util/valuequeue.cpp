@@ -0,0 +1,72 @@
+#include "valuequeue.h"
+
+#include <private/qv4arrayobject_p.h>
+#include <private/qv4scopedvalue_p.h>
+
+using namespace NodeQml;
+
+namespace {
+const uint InitialCapacity = 64;
+}
+
+ValueQueue::ValueQueue(QV4::ExecutionEngine *v4) :
+    m_v4(v4)
+{
+
+}
+
+void ValueQueue::enqueue(QV4::ReturnedValue value)
+{
+    if (m_size == m_capacity)
+        grow();
+
+    QV4::Scope scope(m_v4);
+    QV4::ScopedArrayObject storage(scope, m_storage);
+    QV4::ScopedValue v(scope, value);
+    storage->putIndexed((m_head + m_size) & (m_capacity - 1), v);
+    ++m_size;
+}
+
+QV4::ReturnedValue ValueQueue::dequeue()
+{
+    Q_ASSERT(m_size);
+
+    QV4::Scope scope(m_v4);
+    QV4::ScopedArrayObject storage(scope, m_storage);
+    QV4::ScopedValue v(scope, storage->getIndexed(m_head));
+    QV4::ScopedValue undefined(scope, QV4::Primitive::undefinedValue());
+
+    // Release the slot so that the GC can collect the value
+    storage->putIndexed(m_head, undefined);
+    m_head = (m_head + 1) & (m_capacity - 1);
+    --m_size;
+
+    return v.asReturnedValue();
+}
+
+void ValueQueue::clear()
+{
+    m_storage = QV4::Encode::undefined();
+    m_capacity = 0;
+    m_head = 0;
+    m_size = 0;
+}
+
+void ValueQueue::grow()
+{
+    const uint capacity = m_capacity ? m_capacity * 2 : InitialCapacity;
+
+    QV4::Scope scope(m_v4);
+    QV4::ScopedArrayObject storage(scope, m_v4->newArrayObject(capacity));
+    QV4::ScopedArrayObject oldStorage(scope, m_storage);
+    QV4::ScopedValue v(scope);
+
+    for (uint i = 0; i < m_size; ++i) {
+        v = oldStorage->getIndexed((m_head + i) & (m_capacity - 1));
+        storage->putIndexed(i, v);
+    }
+
+    m_storage = storage.asReturnedValue();
+    m_capacity = capacity;
+    m_head = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef VALUEQUEUE_H
+#define VALUEQUEUE_H
+
+#include <private/qv4engine_p.h>
+#include <private/qv4persistent_p.h>
+
+namespace NodeQml {
+
+/// FIFO ring buffer of JS values. The slots live in a single V4 array that is
+/// rooted by one persistent value, so queueing does not allocate per entry.
+class ValueQueue
+{
+public:
+    explicit ValueQueue(QV4::ExecutionEngine *v4);
+
+    bool isEmpty() const { return !m_size; }
+    uint size() const { return m_size; }
+
+    void enqueue(QV4::ReturnedValue value);
+    QV4::ReturnedValue dequeue();
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ValueQueue)
+
+    void grow();
+
+    QV4::ExecutionEngine *m_v4;
+    QV4::PersistentValue m_storage;
+    uint m_capacity = 0;
+    uint m_head = 0;
+    uint m_size = 0;
+};
+
+} // namespace NodeQml
+
+#endif // VALUEQUEUE_H
@@ -0,0 +1,48 @@
+// Concatenates `chunks` Buffers of chunkSize bytes, `iterations` times, with
+// the native Buffer.concat and with the copy loop scripts used before it
+// existed, and prints the time per concatenation. Run by the concatbench tool.
+
+var performance = require('perf_hooks').performance;
+
+function concatScript(list) {
+    var length = 0;
+    var i;
+    for (i = 0; i < list.length; ++i)
+        length += list[i].length;
+
+    var result = new Buffer(length);
+    var offset = 0;
+    for (i = 0; i < list.length; ++i) {
+        list[i].copy(result, offset);
+        offset += list[i].length;
+    }
+    return result;
+}
+
+function measure(label, concat, list, iterations) {
+    // Warm up, and keep the result to check it against the other variant
+    var result = concat(list);
+
+    var start = performance.now();
+    for (var i = 0; i < iterations; ++i)
+        concat(list);
+    var elapsed = performance.now() - start;
+
+    console.log(label + ': ' + (elapsed / iterations).toFixed(3) + ' ms per concat of '
+                + list.length + ' chunks');
+    return result;
+}
+
+module.exports = function(chunks, chunkSize, iterations) {
+    var list = [];
+    for (var i = 0; i < chunks; ++i) {
+        var chunk = new Buffer(chunkSize);
+        chunk.fill(i & 0xff);
+        list.push(chunk);
+    }
+
+    var native = measure('native', function(list) { return Buffer.concat(list); }, list, iterations);
+    var script = measure('script', concatScript, list, iterations);
+    if (!native.equals(script))
+        throw new Error('Results differ');
+};
@@ -0,0 +1,14 @@
+include(../tools.pri)
+
+QT += core qml
+QT -= gui
+
+TARGET = concatbench
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += main.cpp
+
+RESOURCES += concatbench.qrc
@@ -0,0 +1,48 @@
+#include "../../src/nodeqml/engine.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QQmlEngine>
+#include <QTextStream>
+
+// Compares the native Buffer.concat with concatenating in script, for the
+// many small chunks stream consumers collect.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Buffer.concat benchmark, native vs script"));
+    parser.addHelpOption();
+
+    QCommandLineOption chunksOption(QStringLiteral("chunks"), QStringLiteral("Buffers per concat."),
+                                    QStringLiteral("count"), QStringLiteral("10000"));
+    QCommandLineOption chunkSizeOption(QStringLiteral("chunk-size"), QStringLiteral("Bytes per Buffer."),
+                                       QStringLiteral("bytes"), QStringLiteral("64"));
+    QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Concats per variant."),
+                                        QStringLiteral("count"), QStringLiteral("100"));
+    parser.addOption(chunksOption);
+    parser.addOption(chunkSizeOption);
+    parser.addOption(iterationsOption);
+    parser.process(app);
+
+    const int chunks = qMax(1, parser.value(chunksOption).toInt());
+    const int chunkSize = qMax(1, parser.value(chunkSizeOption).toInt());
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+    QScopedPointer<QQmlEngine> engine(new QQmlEngine());
+    QScopedPointer<NodeQml::Engine> node(new NodeQml::Engine(engine.data()));
+
+    QJSValue benchmark = node->require(QStringLiteral(":/concatbench/concatbench.js"));
+    if (!benchmark.isCallable())
+        return 1;
+
+    // Runs synchronously, so no event loop is needed
+    const QJSValue result = benchmark.call(QJSValueList() << chunks << chunkSize << iterations);
+    if (result.isError()) {
+        QTextStream(stderr) << result.toString() << endl;
+        return 1;
+    }
+
+    return 0;
+}
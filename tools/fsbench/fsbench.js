@@ -0,0 +1,50 @@
+// Issues `reads` random, block aligned fs.read() calls of blockSize bytes on
+// path, keeping `concurrency` of them in flight, and prints the throughput.
+// The fsbench tool runs it once per I/O backend.
+
+var fs = require('fs');
+var performance = require('perf_hooks').performance;
+
+module.exports = function(label, path, reads, concurrency, blockSize) {
+    fs.stat(path, function(er, stats) {
+        if (er)
+            throw er;
+
+        var blocks = Math.floor(stats.size / blockSize);
+        fs.open(path, 'r', 438, function(er, fd) {
+            if (er)
+                throw er;
+
+            var issued = 0;
+            var completed = 0;
+            var start = performance.now();
+
+            function finish() {
+                var elapsed = performance.now() - start;
+                console.log(label + ': ' + reads + ' reads in ' + elapsed.toFixed(1) + ' ms, '
+                            + Math.round(reads / elapsed * 1000) + ' reads/s, '
+                            + (elapsed * 1000 / reads).toFixed(2) + ' us/read');
+                fs.close(fd, function() {});
+            }
+
+            // One buffer per slot, so the loop measures the reads rather than allocation
+            function issue(buffer) {
+                var position = Math.floor(Math.random() * blocks) * blockSize;
+                ++issued;
+                fs.read(fd, buffer, 0, blockSize, position, function(er, bytesRead) {
+                    if (er)
+                        throw er;
+
+                    ++completed;
+                    if (issued < reads)
+                        issue(buffer);
+                    else if (completed === reads)
+                        finish();
+                });
+            }
+
+            for (var i = 0; i < Math.min(concurrency, reads); ++i)
+                issue(new Buffer(blockSize));
+        });
+    });
+};
@@ -0,0 +1,106 @@
+#include "../../src/nodeqml/engine.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QQmlEngine>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace {
+
+bool createFile(const QString &path, qint64 size)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray chunk(1024 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < chunk.size(); ++i)
+        chunk[i] = char(i * 131 + 7);
+
+    for (qint64 written = 0; written < size; written += chunk.size()) {
+        if (file.write(chunk) != chunk.size())
+            return false;
+    }
+    return true;
+}
+
+// The backend is picked when the engine starts, so every run gets a fresh one
+bool run(const QString &label, const QString &path, int reads, int concurrency, int blockSize)
+{
+    QScopedPointer<QQmlEngine> engine(new QQmlEngine());
+    QScopedPointer<NodeQml::Engine> node(new NodeQml::Engine(engine.data()));
+
+    QJSValue benchmark = node->require(QStringLiteral(":/fsbench/fsbench.js"));
+    if (!benchmark.isCallable())
+        return false;
+
+    QEventLoop loop;
+    QObject::connect(node.data(), &NodeQml::Engine::drained, &loop, &QEventLoop::quit);
+
+    const QJSValue result = benchmark.call(QJSValueList() << label << path << reads << concurrency << blockSize);
+    if (result.isError())
+        return false;
+
+    loop.exec();
+    return !node->hasException();
+}
+
+}
+
+// Compares fs.read() on the worker pool with the io_uring backend for small
+// random reads. The file is freshly written and therefore in the page cache,
+// so the numbers show the per-request overhead of each backend rather than
+// device latency. Without CONFIG+=nodeqml_io_uring both runs use the pool.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Random fs.read() benchmark, worker pool vs io_uring"));
+    parser.addHelpOption();
+
+    QCommandLineOption readsOption(QStringLiteral("reads"), QStringLiteral("Reads per run."),
+                                   QStringLiteral("count"), QStringLiteral("100000"));
+    QCommandLineOption concurrencyOption(QStringLiteral("concurrency"), QStringLiteral("Reads in flight."),
+                                         QStringLiteral("count"), QStringLiteral("32"));
+    QCommandLineOption blockSizeOption(QStringLiteral("block-size"), QStringLiteral("Bytes per read."),
+                                       QStringLiteral("bytes"), QStringLiteral("4096"));
+    QCommandLineOption fileSizeOption(QStringLiteral("file-size"), QStringLiteral("Size of the test file in MB."),
+                                      QStringLiteral("MB"), QStringLiteral("256"));
+    parser.addOption(readsOption);
+    parser.addOption(concurrencyOption);
+    parser.addOption(blockSizeOption);
+    parser.addOption(fileSizeOption);
+    parser.process(app);
+
+    const int reads = qMax(1, parser.value(readsOption).toInt());
+    const int concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+    const int blockSize = qMax(1, parser.value(blockSizeOption).toInt());
+    const qint64 fileSize = qMax(1, parser.value(fileSizeOption).toInt()) * Q_INT64_C(1024 * 1024);
+
+    QTextStream err(stderr);
+
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/fsbench.dat");
+    if (!dir.isValid() || !createFile(path, fileSize)) {
+        err << "Cannot create the test file" << endl;
+        return 1;
+    }
+
+    qunsetenv("NODEQML_DISABLE_IO_URING");
+    if (!run(QStringLiteral("io_uring"), path, reads, concurrency, blockSize)) {
+        err << "io_uring run failed" << endl;
+        return 1;
+    }
+
+    qputenv("NODEQML_DISABLE_IO_URING", "1");
+    if (!run(QStringLiteral("pool"), path, reads, concurrency, blockSize)) {
+        err << "pool run failed" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -20,8 +20,12 @@ int main(int argc, char *argv[])
 
     const QString script = parser.positionalArguments().first();
 
+    /// NOTE: There is no startup snapshot (--snapshot-blob): V4 has no heap
+    /// serializer, and its objects point into internal classes, vtables and
+    /// generated code that would not survive a reload.
     QScopedPointer<QQmlEngine> engine(new QQmlEngine());
     QScopedPointer<NodeQml::Engine> node(new NodeQml::Engine(engine.data()));
+    QObject::connect(node.data(), &NodeQml::Engine::drained, &QCoreApplication::quit);
 
     QJSValue object = node->require(script);
     if (object.isUndefined()) {
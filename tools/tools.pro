@@ -1,4 +1,6 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
-    nodeqml
+    nodeqml \
+    fsbench \
+    concatbench